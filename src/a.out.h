@@ -79,6 +79,16 @@ enum machine_type
    The first page is unmapped to help trap NULL pointer references */
 #define MAGIC_QMAGIC 0314
 
+/* File offsets of the sections, relative to the start of the a.out file.
+   ZMAGIC text starts at 1KB, QMAGIC text includes the header. */
+#define N_TXTOFF(x) \
+	(N_MAGIC(x) == MAGIC_ZMAGIC ? 1024 : (N_MAGIC(x) == MAGIC_QMAGIC ? 0 : sizeof(struct exec)))
+#define N_DATOFF(x)	(N_TXTOFF(x) + (x).a_text)
+#define N_TRELOFF(x)	(N_DATOFF(x) + (x).a_data)
+#define N_DRELOFF(x)	(N_TRELOFF(x) + (x).a_trsize)
+#define N_SYMOFF(x)	(N_DRELOFF(x) + (x).a_drsize)
+#define N_STROFF(x)	(N_SYMOFF(x) + (x).a_syms)
+
 // https://en.wikipedia.org/wiki/FLAGS_register
 #define EFLAG_CF 0x0001
 #define EFLAG_PF 0x0004
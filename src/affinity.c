@@ -0,0 +1,309 @@
+/**
+ * @file affinity.c
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief placement of the controller and the a.out host process on CPUs.
+ *
+ * @details Every ptrace stop wakes up the controller and then the tracee
+ * again, which is cheapest if both share a core (or at least a last level
+ * cache). The topology is read from /sys/devices/system/cpu. Concurrently
+ * launched pairs are spread across last level cache domains, which are
+ * ordered such that consecutive domains are on different NUMA nodes.
+ */
+
+#define _GNU_SOURCE
+
+#undef __x86_64__ // undefine x86_64 env to make vscode
+				  // use 32-bit header files
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include "affinity.h"
+
+#define MAX_DOMAINS 64
+#define SYSFS_CPU "/sys/devices/system/cpu/cpu%d/"
+
+// indexed by enum placement_policy
+static const char *policy_names[] = { "none", "core", "smt", "auto" };
+
+struct domain {
+    cpu_set_t cpus;
+    int node;
+    int rank; /* index among the domains of the same node */
+};
+
+/* read_cpulist
+ * @brief reads a sysfs CPU list (e.g. "0-3,8-11") into a CPU set.
+ * @param path the path of the sysfs file.
+ * @param set the CPU set to fill.
+ *
+ * Returns false if the file does not exist.
+ **/
+static bool read_cpulist(const char *path, cpu_set_t *set)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+
+    CPU_ZERO(set);
+    unsigned int first, last;
+    while (fscanf(file, "%u", &first) == 1) {
+        last = first;
+        int separator = fgetc(file);
+        if (separator == '-') {
+            if (fscanf(file, "%u", &last) != 1) {
+                break;
+            }
+            separator = fgetc(file);
+        }
+        for (unsigned int cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) {
+            CPU_SET(cpu, set);
+        }
+        if (separator != ',') {
+            break;
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+/* node_of
+ * @brief returns the NUMA node of a CPU, 0 if the system has no NUMA support.
+ * @param cpu the CPU number.
+ **/
+static int node_of(int cpu)
+{
+    char path[64];
+    snprintf(path, sizeof(path), SYSFS_CPU, cpu);
+
+    DIR *directory = opendir(path);
+    if (directory == NULL) {
+        return 0;
+    }
+
+    int node = 0;
+    struct dirent *entry;
+    while ((entry = readdir(directory)) != NULL) {
+        if (sscanf(entry->d_name, "node%d", &node) == 1) {
+            break;
+        }
+    }
+    closedir(directory);
+    return node;
+}
+
+/* read_siblings
+ * @brief reads the CPUs of the core a CPU belongs to (including itself).
+ * @param cpu the CPU number.
+ * @param set the CPU set to fill.
+ **/
+static void read_siblings(int cpu, cpu_set_t *set)
+{
+    char path[128];
+    snprintf(path, sizeof(path), SYSFS_CPU "topology/thread_siblings_list", cpu);
+    if (!read_cpulist(path, set)) {
+        CPU_ZERO(set);
+        CPU_SET(cpu, set);
+    }
+}
+
+/* read_llc
+ * @brief reads the CPUs sharing the last level cache with a CPU.
+ * @param cpu the CPU number.
+ * @param set the CPU set to fill.
+ *
+ * @details Uses the highest cache index available, if sysfs does not
+ * provide cache information, all CPUs are assumed to share one cache.
+ **/
+static void read_llc(int cpu, cpu_set_t *set)
+{
+    char path[128];
+    for (int index = 3; index >= 0; index--) {
+        snprintf(path, sizeof(path), SYSFS_CPU "cache/index%d/shared_cpu_list", cpu, index);
+        if (read_cpulist(path, set)) {
+            return;
+        }
+    }
+    sched_getaffinity(0, sizeof(cpu_set_t), set);
+}
+
+static int compare_domains(const void *a, const void *b)
+{
+    const struct domain *x = a, *y = b;
+    if (x->rank != y->rank) {
+        return x->rank - y->rank;
+    }
+    return x->node - y->node;
+}
+
+/* parse_placement_policy
+ * @brief parses the argument of -c.
+ * @param name one of "none", "core", "smt" or "auto".
+ * @param policy the policy to set.
+ *
+ * Returns false if the name is unknown.
+ **/
+bool parse_placement_policy(const char *name, enum placement_policy *policy)
+{
+    for (size_t i = 0; i < sizeof(policy_names) / sizeof(policy_names[0]); i++) {
+        if (strcmp(name, policy_names[i]) == 0) {
+            *policy = (enum placement_policy)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* compute_placement
+ * @brief chooses the CPUs of the controller and the tracee.
+ * @param policy the placement policy.
+ * @param sequence number of the launch within the controller.
+ * @param placement the placement to fill.
+ *
+ * @details Only CPUs in the current affinity mask are considered. The
+ * last level cache domain and the core within it are chosen based on
+ * the PID of the controller and the sequence number, such that pairs
+ * launched by one or by several controllers do not end up on the same core.
+ * Returns false if nothing should be pinned.
+ **/
+bool compute_placement(enum placement_policy policy, unsigned int sequence, struct placement *placement)
+{
+    memset(placement, 0, sizeof(struct placement));
+    placement->policy = policy;
+    placement->controller_cpu = -1;
+    placement->tracee_cpu = -1;
+    if (policy == PLACEMENT_NONE) {
+        return false;
+    }
+
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed) != 0) {
+        return false;
+    }
+
+    // collect the last level cache domains.
+    static struct domain domains[MAX_DOMAINS];
+    int count = 0;
+    for (int cpu = 0; cpu < CPU_SETSIZE && count < MAX_DOMAINS; cpu++) {
+        if (!CPU_ISSET(cpu, &allowed)) {
+            continue;
+        }
+        cpu_set_t llc;
+        read_llc(cpu, &llc);
+        CPU_AND(&llc, &llc, &allowed);
+
+        int i = 0;
+        while (i < count && !CPU_EQUAL(&domains[i].cpus, &llc)) {
+            i++;
+        }
+        if (i == count) {
+            domains[count].cpus = llc;
+            domains[count].node = node_of(cpu);
+            domains[count].rank = 0;
+            for (int j = 0; j < count; j++) {
+                if (domains[j].node == domains[count].node) {
+                    domains[count].rank++;
+                }
+            }
+            count++;
+        }
+    }
+    if (count == 0) {
+        return false;
+    }
+
+    // interleave the NUMA nodes: node 0, node 1, ..., node 0, node 1, ...
+    qsort(domains, count, sizeof(struct domain), compare_domains);
+    unsigned int spread = getpid() + sequence;
+    placement->llcs = count;
+    placement->llc = spread % count;
+    struct domain *domain = &domains[placement->llc];
+    placement->node = domain->node;
+
+    // choose a core of the domain, i.e. the first thread of its siblings.
+    int cores[CPU_SETSIZE], ncores = 0;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &domain->cpus)) {
+            continue;
+        }
+        cpu_set_t siblings;
+        read_siblings(cpu, &siblings);
+        CPU_AND(&siblings, &siblings, &domain->cpus);
+        int first = 0;
+        while (!CPU_ISSET(first, &siblings)) {
+            first++;
+        }
+        if (first == cpu) {
+            cores[ncores++] = cpu;
+        }
+    }
+    int core = cores[(spread / count) % ncores];
+    placement->controller_cpu = core;
+    placement->tracee_cpu = core;
+
+    if (policy == PLACEMENT_SMT || policy == PLACEMENT_AUTO) {
+        cpu_set_t siblings;
+        read_siblings(core, &siblings);
+        CPU_AND(&siblings, &siblings, &domain->cpus);
+        CPU_CLR(core, &siblings);
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &siblings)) {
+                placement->tracee_cpu = cpu;
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+/* apply_placement
+ * @brief pins the controller (calling process) and the tracee.
+ * @param placement the placement computed by compute_placement.
+ * @param tracee the PID of the a.out host process.
+ * @param controller whether the calling thread (the tracer) is pinned as well.
+ *
+ * @details Processes created by the tracee inherit its affinity, i.e. they
+ * all share a single CPU. Returns false if the affinity could not be set.
+ **/
+bool apply_placement(struct placement *placement, pid_t tracee, bool controller)
+{
+    if (placement->controller_cpu < 0) {
+        return false;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(placement->controller_cpu, &set);
+    if (controller && sched_setaffinity(0, sizeof(cpu_set_t), &set) != 0) {
+        return false;
+    }
+
+    CPU_ZERO(&set);
+    CPU_SET(placement->tracee_cpu, &set);
+    return sched_setaffinity(tracee, sizeof(cpu_set_t), &set) == 0;
+}
+
+/* print_placement
+ * @brief prints the placement, e.g. when the controller exits.
+ * @param file the file to print to.
+ * @param placement the placement computed by compute_placement.
+ **/
+void print_placement(FILE *file, struct placement *placement)
+{
+    if (placement->controller_cpu < 0) {
+        fprintf(file, "placement: %s\n", policy_names[placement->policy]);
+        return;
+    }
+    fprintf(file, "placement: %s, controller on cpu %d (last ran on %d), tracee on cpu %d, llc domain %d/%d, node %d\n",
+        policy_names[placement->policy], placement->controller_cpu, sched_getcpu(),
+        placement->tracee_cpu, placement->llc, placement->llcs, placement->node);
+}
@@ -0,0 +1,37 @@
+/**
+ * @file affinity.h
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief placement of the controller and the a.out host process on CPUs.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+#ifndef AFFINITY_H
+#define AFFINITY_H
+
+enum placement_policy {
+    PLACEMENT_NONE, // leave it to the scheduler
+    PLACEMENT_CORE, // controller and tracee share one CPU
+    PLACEMENT_SMT,  // controller and tracee run on sibling SMT threads
+    PLACEMENT_AUTO  // PLACEMENT_SMT if the core has siblings, PLACEMENT_CORE otherwise
+};
+
+struct placement {
+    enum placement_policy policy;
+    int controller_cpu;
+    int tracee_cpu;
+    int llc;  /* index of the last level cache domain */
+    int llcs; /* number of last level cache domains */
+    int node; /* NUMA node of the domain */
+};
+
+bool parse_placement_policy(const char *name, enum placement_policy *policy);
+bool compute_placement(enum placement_policy policy, unsigned int sequence, struct placement *placement);
+bool apply_placement(struct placement *placement, pid_t tracee, bool controller);
+void print_placement(FILE *file, struct placement *placement);
+
+#endif
@@ -0,0 +1,280 @@
+/**
+ * @file archive.c
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief access to a.out files stored as members of ar and tar archives.
+ *
+ * @details A member is named "archive(member)", like in make. The archive
+ * is never extracted, only the offset and size of the member are looked up,
+ * such that page aligned QMAGIC members can be mapped straight out of the
+ * archive and all other members are converted from their offset.
+ * Supported are ar archives (System V/GNU and BSD long names),
+ * ustar/GNU tar archives (including GNU long names) and bundles (see bundle.c).
+ */
+
+#undef __x86_64__ // undefine x86_64 env to make vscode
+				  // use 32-bit header files
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "archive.h"
+#include "bundle.h"
+
+#define AR_MAGIC "!<arch>\n"
+#define AR_HEADER_SIZE 60
+#define TAR_BLOCK 512
+#define TAR_MAGIC "ustar"
+
+// NOTE: all fields are padded with spaces
+struct ar_header {
+    char name[16];
+    char date[12];
+    char uid[6];
+    char gid[6];
+    char mode[8];
+    char size[10];
+    char fmag[2];
+};
+
+struct tar_header {
+    char name[100];
+    char mode[8];
+    char uid[8];
+    char gid[8];
+    char size[12];
+    char mtime[12];
+    char checksum[8];
+    char typeflag;
+    char linkname[100];
+    char magic[6];
+    char version[2];
+    char uname[32];
+    char gname[32];
+    char devmajor[8];
+    char devminor[8];
+    char prefix[155];
+    char padding[12];
+};
+
+/* parse_number
+ * @brief parses a fixed width, unterminated number field of an archive header.
+ * @param field the field.
+ * @param width the width of the field.
+ * @param base 10 for ar, 8 for tar.
+ **/
+static off_t parse_number(const char *field, int width, int base)
+{
+    char buffer[16];
+    int length = width < (int)sizeof(buffer) - 1 ? width : (int)sizeof(buffer) - 1;
+    memcpy(buffer, field, length);
+    buffer[length] = '\0';
+    return strtoll(buffer, NULL, base);
+}
+
+/* find_ar_member
+ * @brief searches an ar archive for a member.
+ * @param member the archive, offset and size are set if the member is found.
+ * @param name the name of the member.
+ *
+ * @details Sets errno to ENOEXEC if a header is corrupt, i.e. a size is
+ * negative or runs past the end of the archive.
+ **/
+static bool find_ar_member(struct member *member, const char *name)
+{
+    size_t name_length = strlen(name);
+    char *long_names = NULL;
+    off_t long_names_size = 0;
+    off_t offset = strlen(AR_MAGIC);
+    struct ar_header header;
+
+    while (pread(member->fd, &header, AR_HEADER_SIZE, offset) == AR_HEADER_SIZE) {
+        off_t data = offset + AR_HEADER_SIZE;
+        off_t size = parse_number(header.size, sizeof(header.size), 10);
+        if (size < 0 || size > member->size - data) {
+            errno = ENOEXEC;
+            break;
+        }
+        offset = data + size + (size & 1); // members are 2 byte aligned
+
+        char found[PATH_MAX];
+        int length = 0;
+        if (header.name[0] == '/' && header.name[1] == '/') {
+            // GNU long name table, names are terminated by "/\n".
+            free(long_names);
+            long_names = malloc(size);
+            long_names_size = size;
+            if (long_names == NULL || pread(member->fd, long_names, size, data) != size) {
+                break;
+            }
+            continue;
+        } else if (header.name[0] == '/' && header.name[1] >= '0' && header.name[1] <= '9') {
+            // GNU long name: "/<offset in the long name table>"
+            off_t start = parse_number(header.name + 1, sizeof(header.name) - 1, 10);
+            while (long_names != NULL && start + length < long_names_size
+                && long_names[start + length] != '/' && length < (off_t)sizeof(found) - 1) {
+                found[length] = long_names[start + length];
+                length++;
+            }
+        } else if (strncmp(header.name, "#1/", 3) == 0) {
+            // BSD long name: "#1/<length>", the name precedes the data.
+            off_t name_size = parse_number(header.name + 3, sizeof(header.name) - 3, 10);
+            if (name_size < 0 || name_size > size) {
+                errno = ENOEXEC;
+                break;
+            }
+            length = name_size < (off_t)sizeof(found) - 1 ? name_size : (off_t)sizeof(found) - 1;
+            if (pread(member->fd, found, length, data) != length) {
+                break;
+            }
+            length = strnlen(found, length);
+            data += name_size;
+            size -= name_size;
+        } else if (header.name[0] != '/') {
+            // short name, terminated by '/' (GNU) or padded with spaces (BSD).
+            while (length < (int)sizeof(header.name) && header.name[length] != '/' && header.name[length] != ' ') {
+                found[length] = header.name[length];
+                length++;
+            }
+        }
+
+        if ((size_t)length == name_length && memcmp(found, name, length) == 0) {
+            member->offset = data;
+            member->size = size;
+            free(long_names);
+            return true;
+        }
+    }
+
+    free(long_names);
+    return false;
+}
+
+/* find_tar_member
+ * @brief searches a tar archive for a member.
+ * @param member the archive, offset and size are set if the member is found.
+ * @param name the name of the member, a leading "./" is ignored.
+ *
+ * @details Sets errno to ENOEXEC if a header is corrupt, see find_ar_member.
+ **/
+static bool find_tar_member(struct member *member, const char *name)
+{
+    if (strncmp(name, "./", 2) == 0) {
+        name += 2;
+    }
+
+    char long_name[PATH_MAX] = "";
+    off_t offset = 0;
+    struct tar_header header;
+    while (pread(member->fd, &header, TAR_BLOCK, offset) == TAR_BLOCK && header.name[0] != '\0') {
+        off_t data = offset + TAR_BLOCK;
+        off_t size = parse_number(header.size, sizeof(header.size), 8);
+        if (size < 0 || size > member->size - data) {
+            errno = ENOEXEC;
+            break;
+        }
+        offset = data + (size + TAR_BLOCK - 1) / TAR_BLOCK * TAR_BLOCK;
+
+        if (header.typeflag == 'L') {
+            // GNU long name of the next member.
+            off_t length = size < (off_t)sizeof(long_name) - 1 ? size : (off_t)sizeof(long_name) - 1;
+            if (pread(member->fd, long_name, length, data) != length) {
+                break;
+            }
+            long_name[length] = '\0';
+            continue;
+        }
+
+        char found[PATH_MAX];
+        if (long_name[0] != '\0') {
+            snprintf(found, sizeof(found), "%s", long_name);
+            long_name[0] = '\0';
+        } else if (header.prefix[0] != '\0') {
+            snprintf(found, sizeof(found), "%.*s/%.*s", (int)sizeof(header.prefix), header.prefix,
+                (int)sizeof(header.name), header.name);
+        } else {
+            snprintf(found, sizeof(found), "%.*s", (int)sizeof(header.name), header.name);
+        }
+
+        const char *stored = strncmp(found, "./", 2) == 0 ? found + 2 : found;
+        bool regular = header.typeflag == '0' || header.typeflag == '\0' || header.typeflag == '7';
+        if (regular && strcmp(stored, name) == 0) {
+            member->offset = data;
+            member->size = size;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* open_member
+ * @brief opens a file or a member of an archive.
+ * @param name the path of a file or "archive(member)".
+ * @param flags the flags for open, e.g. O_RDONLY | O_CLOEXEC.
+ * @param member the file or member to fill.
+ *
+ * @details A name is only treated as an archive member if no file of that
+ * name exists. Returns false and sets errno (ENOENT if the member does not
+ * exist, ENOEXEC if the archive format is unknown or the archive is corrupt). Compressed bundle
+ * members are opened decompressed, member->path is a /proc path then.
+ **/
+bool open_member(const char *name, int flags, struct member *member)
+{
+    memset(member, 0, sizeof(struct member));
+    snprintf(member->path, sizeof(member->path), "%s", name);
+
+    char *open_paren = strrchr(member->path, '(');
+    size_t length = strlen(member->path);
+    char *member_name = NULL;
+    member->fd = open(member->path, flags);
+    if (member->fd == -1 && errno == ENOENT && open_paren != NULL
+        && open_paren != member->path && member->path[length - 1] == ')') {
+        member->path[length - 1] = '\0';
+        *open_paren = '\0';
+        member_name = open_paren + 1;
+        member->fd = open(member->path, flags);
+    }
+    if (member->fd == -1) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(member->fd, &st) != 0) {
+        close(member->fd);
+        return false;
+    }
+    member->size = st.st_size;
+    if (member_name == NULL) {
+        return true;
+    }
+
+    char magic[TAR_BLOCK];
+    bool found = false;
+    errno = ENOEXEC;
+    if (is_bundle(member->fd)) {
+        found = find_bundle_member(member, member_name);
+    } else if (pread(member->fd, magic, strlen(AR_MAGIC), 0) == strlen(AR_MAGIC)
+        && memcmp(magic, AR_MAGIC, strlen(AR_MAGIC)) == 0) {
+        errno = ENOENT;
+        found = find_ar_member(member, member_name);
+    } else if (pread(member->fd, magic, TAR_BLOCK, 0) == TAR_BLOCK
+        && memcmp(magic + offsetof(struct tar_header, magic), TAR_MAGIC, strlen(TAR_MAGIC)) == 0) {
+        errno = ENOENT;
+        found = find_tar_member(member, member_name);
+    }
+
+    if (!found) {
+        int error = errno;
+        close(member->fd);
+        member->fd = -1;
+        errno = error;
+    }
+    return found;
+}
@@ -0,0 +1,26 @@
+/**
+ * @file archive.h
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief access to a.out files stored as members of ar and tar archives.
+ */
+
+#include <stdbool.h>
+#include <sys/types.h>
+#include <linux/limits.h>
+
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+// a file or a member of an archive, named "archive(member)".
+struct member {
+    int fd;              /* file descriptor of the file or archive */
+    char path[PATH_MAX]; /* path of the file or archive */
+    off_t offset;        /* offset of the member in the archive, 0 for files */
+    off_t size;          /* size of the file or member */
+};
+
+bool open_member(const char *name, int flags, struct member *member);
+
+#endif
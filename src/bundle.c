@@ -0,0 +1,373 @@
+/**
+ * @file bundle.c
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief single-file bundles of a.out executables, libraries and data files.
+ *
+ * @details A bundle is an index (struct bundle_header and one struct
+ * bundle_entry per member) followed by the members, each at a page aligned
+ * offset. Members are accessed like archive members, "bundle(member)", see
+ * open_member. QMAGIC members are stored as is, thus they are mapped straight
+ * out of the bundle. Other members are stored zlib compressed, if that saves
+ * at least a page, and are decompressed once into a sealed memfd, which is
+ * shared by every later open of the member in this process and by all
+ * tracees mapping it.
+ */
+
+#define _GNU_SOURCE // memfd_create
+
+#undef __x86_64__ // undefine x86_64 env to make vscode
+				  // use 32-bit header files
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#include "bundle.h"
+#include "helpers.h"
+
+#define BUNDLE_MAX_MEMBERS 65536
+
+// a decompressed member, kept open until the process exits.
+struct decompressed {
+    dev_t dev;
+    ino_t ino;
+    struct timespec mtime;
+    uint64_t offset;
+    int fd;
+    struct decompressed *next;
+};
+
+static struct decompressed *decompressed = NULL;
+static pthread_mutex_t decompressed_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* page_align
+ * @brief rounds an offset up to the next page boundary.
+ **/
+static uint64_t page_align(uint64_t offset)
+{
+    uint64_t page = sysconf(_SC_PAGESIZE);
+    return (offset + page - 1) / page * page;
+}
+
+/* is_bundle
+ * @brief returns true if the file starts with the bundle magic.
+ * @param fd file descriptor of the file.
+ **/
+bool is_bundle(int fd)
+{
+    char magic[sizeof(BUNDLE_MAGIC) - 1];
+    return pread(fd, magic, sizeof(magic), 0) == sizeof(magic)
+        && memcmp(magic, BUNDLE_MAGIC, sizeof(magic)) == 0;
+}
+
+/* decompress_member
+ * @brief decompresses a member into a new sealed memfd.
+ * @param fd file descriptor of the bundle.
+ * @param entry the compressed member.
+ *
+ * @details Returns the memfd or -1 with errno set.
+ **/
+static int decompress_member(int fd, struct bundle_entry *entry)
+{
+    int target = memfd_create("aout-bundle", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (target == -1) {
+        return -1;
+    }
+    if (entry->size == 0 || entry->stored_size == 0 || ftruncate(target, entry->size) != 0) {
+        close(target);
+        errno = ENOEXEC;
+        return -1;
+    }
+
+    void *source = mmap(NULL, entry->stored_size, PROT_READ, MAP_PRIVATE, fd, entry->offset);
+    void *data = mmap(NULL, entry->size, PROT_READ | PROT_WRITE, MAP_SHARED, target, 0);
+    bool decompressed = false;
+    if (source != MAP_FAILED && data != MAP_FAILED) {
+        uLongf length = entry->size;
+        decompressed = uncompress(data, &length, source, entry->stored_size) == Z_OK
+            && length == entry->size
+            && crc32(0, data, length) == entry->checksum;
+    }
+    if (source != MAP_FAILED) {
+        munmap(source, entry->stored_size);
+    }
+    if (data != MAP_FAILED) {
+        munmap(data, entry->size);
+    }
+
+    if (!decompressed
+        || fcntl(target, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) != 0) {
+        close(target);
+        errno = ENOEXEC;
+        return -1;
+    }
+    fprintf(logfile, "decompressed bundle member %s: 0x%llx -> 0x%llx bytes\n", entry->name,
+        (unsigned long long)entry->stored_size, (unsigned long long)entry->size);
+    return target;
+}
+
+/* decompressed_member
+ * @brief returns the shared memfd of a compressed member, decompressing it on first use.
+ * @param fd file descriptor of the bundle.
+ * @param entry the compressed member.
+ *
+ * @details The memfd must not be closed. Returns -1 with errno set on error.
+ **/
+static int decompressed_member(int fd, struct bundle_entry *entry)
+{
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&decompressed_lock);
+    struct decompressed *current = decompressed;
+    while (current != NULL && !(current->dev == st.st_dev && current->ino == st.st_ino
+        && current->mtime.tv_sec == st.st_mtim.tv_sec && current->mtime.tv_nsec == st.st_mtim.tv_nsec
+        && current->offset == entry->offset)) {
+        current = current->next;
+    }
+    if (current == NULL) {
+        int target = decompress_member(fd, entry);
+        if (target != -1) {
+            current = calloc(1, sizeof(struct decompressed));
+            if (current == NULL) {
+                close(target);
+            } else {
+                current->dev = st.st_dev;
+                current->ino = st.st_ino;
+                current->mtime = st.st_mtim;
+                current->offset = entry->offset;
+                current->fd = target;
+                current->next = decompressed;
+                decompressed = current;
+            }
+        }
+    }
+    int result = current != NULL ? current->fd : -1;
+    pthread_mutex_unlock(&decompressed_lock);
+    return result;
+}
+
+/* find_bundle_member
+ * @brief searches a bundle for a member.
+ * @param member the bundle, offset and size are set if the member is found.
+ * @param name the name of the member.
+ *
+ * @details A compressed member is replaced by (a duplicate of) its decompressed
+ * memfd, member->path is set to a path of the memfd, which the tracees can open.
+ * Returns false and sets errno on error.
+ **/
+bool find_bundle_member(struct member *member, const char *name)
+{
+    struct bundle_header header;
+    if (pread(member->fd, &header, sizeof(header), 0) != sizeof(header)
+        || header.count > BUNDLE_MAX_MEMBERS) {
+        errno = ENOEXEC;
+        return false;
+    }
+
+    size_t index_size = header.count * sizeof(struct bundle_entry);
+    struct bundle_entry *entries = malloc(index_size > 0 ? index_size : 1);
+    if (entries == NULL) {
+        return false;
+    }
+    if (pread(member->fd, entries, index_size, sizeof(header)) != (ssize_t)index_size) {
+        free(entries);
+        errno = ENOEXEC;
+        return false;
+    }
+
+    struct bundle_entry *entry = NULL;
+    for (uint32_t i = 0; i < header.count && entry == NULL; i++) {
+        entries[i].name[BUNDLE_NAME_MAX - 1] = '\0';
+        if (strcmp(entries[i].name, name) == 0) {
+            entry = &entries[i];
+        }
+    }
+    if (entry == NULL) {
+        free(entries);
+        errno = ENOENT;
+        return false;
+    }
+    if (entry->offset > (uint64_t)member->size || entry->stored_size > (uint64_t)member->size - entry->offset) {
+        free(entries);
+        errno = ENOEXEC;
+        return false;
+    }
+
+    if ((entry->flags & BUNDLE_FLAG_COMPRESSED) == 0) {
+        member->offset = entry->offset;
+        member->size = entry->size;
+        free(entries);
+        return true;
+    }
+
+    int shared = decompressed_member(member->fd, entry);
+    int copy = shared != -1 ? fcntl(shared, F_DUPFD_CLOEXEC, 0) : -1;
+    if (copy != -1) {
+        close(member->fd);
+        member->fd = copy;
+        member->offset = 0;
+        member->size = entry->size;
+        snprintf(member->path, sizeof(member->path), "/proc/%d/fd/%d", getpid(), shared);
+    }
+    free(entries);
+    return copy != -1;
+}
+
+/* base_name
+ * @brief returns the name of a file in a bundle: the base name of the file
+ * or of the archive member.
+ * @param file the path of a file or "archive(member)".
+ * @param buffer buffer of BUNDLE_NAME_MAX bytes.
+ *
+ * @details Returns false if the name is too long.
+ **/
+static bool base_name(const char *file, char *buffer)
+{
+    size_t length = strlen(file);
+    if (length > 0 && file[length - 1] == ')') {
+        length--;
+    }
+    const char *start = file + length;
+    while (start > file && start[-1] != '/' && start[-1] != '(') {
+        start--;
+    }
+    length -= start - file;
+    if (length == 0 || length >= BUNDLE_NAME_MAX) {
+        return false;
+    }
+    memcpy(buffer, start, length);
+    buffer[length] = '\0';
+    return true;
+}
+
+/* store_member
+ * @brief writes a file to a bundle under construction.
+ * @param target file descriptor of the bundle.
+ * @param file the path of the file or "archive(member)".
+ * @param entry the entry to fill, entry->offset must be set.
+ *
+ * @details QMAGIC files are stored as is, such that they can be mapped
+ * in place, everything else is compressed if that saves at least a page.
+ **/
+static bool store_member(int target, const char *file, struct bundle_entry *entry)
+{
+    struct member member;
+    if (!open_member(file, O_RDONLY | O_CLOEXEC, &member)) {
+        fprintf(stderr, "Error: cannot open '%s'! %s\n", file, strerror(errno));
+        return false;
+    }
+
+    unsigned char *data = malloc(member.size > 0 ? member.size : 1);
+    bool success = data != NULL && pread(member.fd, data, member.size, member.offset) == member.size;
+    close(member.fd);
+    if (!success) {
+        fprintf(stderr, "Error: cannot read '%s'!\n", file);
+        free(data);
+        return false;
+    }
+    entry->size = member.size;
+    entry->stored_size = member.size;
+    entry->checksum = crc32(0, data, member.size);
+
+    unsigned char *stored = data;
+    unsigned char *compressed = NULL;
+    struct exec *header = (struct exec *)data;
+    bool qmagic = member.size >= (off_t)sizeof(struct exec) && N_MAGIC(*header) == MAGIC_QMAGIC;
+    if (!qmagic && member.size > 0) {
+        uLongf length = compressBound(member.size);
+        compressed = malloc(length);
+        if (compressed != NULL && compress2(compressed, &length, data, member.size, Z_BEST_COMPRESSION) == Z_OK
+            && page_align(length) < page_align(member.size)) {
+            stored = compressed;
+            entry->stored_size = length;
+            entry->flags |= BUNDLE_FLAG_COMPRESSED;
+        }
+    }
+
+    success = pwrite(target, stored, entry->stored_size, entry->offset) == (ssize_t)entry->stored_size;
+    if (success) {
+        fprintf(logfile, "%-20s 0x%08llx bytes at 0x%08llx%s\n", entry->name, (unsigned long long)entry->size,
+            (unsigned long long)entry->offset, (entry->flags & BUNDLE_FLAG_COMPRESSED) ? ", compressed" : "");
+    } else {
+        fprintf(stderr, "Error: cannot write '%s' to the bundle! %s\n", file, strerror(errno));
+    }
+    free(compressed);
+    free(data);
+    return success;
+}
+
+/* create_bundle
+ * @brief creates a bundle of files.
+ * @param path the path of the bundle.
+ * @param files paths of the files or archive members, stored under their base name.
+ * @param count the number of files.
+ *
+ * @details The bundle is written to a temporary file first and renamed
+ * afterwards. Returns false and prints an error on failure.
+ **/
+bool create_bundle(const char *path, char *const files[], int count)
+{
+    if (count < 0 || count > BUNDLE_MAX_MEMBERS) {
+        fprintf(stderr, "Error: too many files for a bundle!\n");
+        return false;
+    }
+    struct bundle_header header = { .count = count };
+    memcpy(header.magic, BUNDLE_MAGIC, sizeof(header.magic));
+    struct bundle_entry *entries = calloc(count > 0 ? count : 1, sizeof(struct bundle_entry));
+    if (entries == NULL) {
+        return false;
+    }
+
+    char temporary[PATH_MAX];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", path);
+    int target = open(temporary, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (target == -1) {
+        fprintf(stderr, "Error: cannot create '%s'! %s\n", temporary, strerror(errno));
+        free(entries);
+        return false;
+    }
+
+    bool success = true;
+    uint64_t offset = page_align(sizeof(header) + count * sizeof(struct bundle_entry));
+    for (int i = 0; i < count && success; i++) {
+        if (!base_name(files[i], entries[i].name)) {
+            fprintf(stderr, "Error: invalid member name '%s'!\n", files[i]);
+            success = false;
+            break;
+        }
+        for (int j = 0; j < i; j++) {
+            if (strcmp(entries[i].name, entries[j].name) == 0) {
+                fprintf(stderr, "Error: '%s' is contained twice!\n", entries[i].name);
+                success = false;
+            }
+        }
+        entries[i].offset = offset;
+        success = success && store_member(target, files[i], &entries[i]);
+        offset = page_align(offset + entries[i].stored_size);
+    }
+
+    success = success
+        && pwrite(target, &header, sizeof(header), 0) == (ssize_t)sizeof(header)
+        && pwrite(target, entries, count * sizeof(struct bundle_entry), sizeof(header)) == (ssize_t)(count * sizeof(struct bundle_entry));
+    if (close(target) != 0 || !success || rename(temporary, path) != 0) {
+        if (success) {
+            fprintf(stderr, "Error: cannot write '%s'! %s\n", path, strerror(errno));
+        }
+        unlink(temporary);
+        success = false;
+    }
+    free(entries);
+    return success;
+}
@@ -0,0 +1,42 @@
+/**
+ * @file bundle.h
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief single-file bundles of a.out executables, libraries and data files.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "archive.h"
+
+#ifndef BUNDLE_H
+#define BUNDLE_H
+
+#define BUNDLE_MAGIC "AOUTBDL1"
+#define BUNDLE_NAME_MAX 64
+
+#define BUNDLE_FLAG_COMPRESSED 0x1 // zlib, decompressed once into a memfd
+
+// the bundle starts with this header, followed by count entries.
+struct bundle_header {
+    char magic[8];
+    uint32_t count;
+    uint32_t reserved;
+};
+
+struct bundle_entry {
+    char name[BUNDLE_NAME_MAX]; /* base name of the file, NUL terminated */
+    uint64_t offset;            /* page aligned offset in the bundle */
+    uint64_t stored_size;       /* size in the bundle */
+    uint64_t size;              /* size of the file */
+    uint32_t flags;             /* BUNDLE_FLAG_* */
+    uint32_t checksum;          /* crc32 of the file */
+};
+
+bool is_bundle(int fd);
+bool find_bundle_member(struct member *member, const char *name);
+bool create_bundle(const char *path, char *const files[], int count);
+
+#endif
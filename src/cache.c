@@ -0,0 +1,546 @@
+/**
+ * @file cache.c
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief persistent cache of converted a.out images.
+ *
+ * @details Every entry is a converted image (see write_image) followed by a
+ * trailer at the next page boundary, such that the entry can be mapped as is,
+ * just like a QMAGIC file, and all processes share its page cache pages.
+ * Entries are content-addressed: they are named after a hash of the header,
+ * text and data of the source and its conversion, thus copies of a file share
+ * an entry and a rewritten file never hits a stale one. Hashing the source is
+ * remembered in a small key file, which is named after the identity of the
+ * source (device, inode, size, mtime, ctime), so a hit of a known file does
+ * not read the source. The trailer repeats the content key and the size and
+ * holds a digest of the converted image, which is verified whenever the entry
+ * is opened: a corrupt entry is reconverted instead of being mapped as code.
+ * Verifying reads the entry once, which also brings it into the page cache
+ * before the tracee maps it. Files are written to a temporary file and
+ * published with rename, readers never see partial files. The least recently
+ * used files are evicted once the cache grows beyond its limit.
+ */
+
+#define _GNU_SOURCE
+
+#undef __x86_64__ // undefine x86_64 env to make vscode
+				  // use 32-bit header files
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "cache.h"
+#include "helpers.h"
+
+#define CACHE_MAGIC "AOUTIMG3"
+#define CACHE_KEY_MAGIC "AOUTKEY1"
+#define CACHE_SUFFIX ".img"
+#define CACHE_KEY_SUFFIX ".key"
+#define CACHE_TEMPORARY "tmp."
+#define CACHE_STALE_SECONDS 3600
+
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+// contents of a source file and its conversion, names an entry.
+struct cache_key {
+    uint64_t hash;        /* FNV-1a hash of the header, text and data */
+    uint32_t magic;
+    uint32_t data_offset;
+    uint32_t length;      /* size of text and data */
+    uint32_t reserved;
+};
+
+// identity of a source file, names a key file.
+struct cache_identity {
+    uint64_t dev;
+    uint64_t ino;
+    uint64_t size;
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+    int64_t ctime_sec;    /* changed by every write, unlike mtime it cannot be set */
+    int64_t ctime_nsec;
+    uint32_t magic;
+    uint32_t text_offset; /* includes the offset of an archive member */
+    uint32_t data_offset;
+    uint32_t reserved;
+};
+
+struct cache_key_file {
+    char magic[8];
+    struct cache_identity identity;
+    struct cache_key key;
+};
+
+struct cache_trailer {
+    char magic[8];
+    struct cache_key key;
+    uint64_t size;   /* size of the converted image */
+    uint64_t digest; /* FNV-1a hash of the converted image */
+};
+
+struct cache_entry {
+    char name[NAME_MAX + 1];
+    struct timespec used;
+    unsigned long size;
+};
+
+/* fnv1a
+ * @brief continues an FNV-1a hash over a buffer.
+ * @param hash the hash so far (FNV_OFFSET for a new hash).
+ * @param data the buffer.
+ * @param length the size of the buffer.
+ **/
+static uint64_t fnv1a(uint64_t hash, const void *data, size_t length)
+{
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+/* hash_range
+ * @brief continues an FNV-1a hash over a part of a file.
+ * @param fd the file.
+ * @param offset the offset of the part.
+ * @param length the size of the part.
+ * @param hash the hash to continue.
+ *
+ * Returns false if the file could not be read.
+ **/
+static bool hash_range(int fd, off_t offset, uint64_t length, uint64_t *hash)
+{
+    char buffer[65536];
+    for (uint64_t done = 0; done < length;) {
+        size_t size = length - done < sizeof(buffer) ? length - done : sizeof(buffer);
+        ssize_t result = pread(fd, buffer, size, offset + done);
+        if (result <= 0) {
+            if (result == -1 && errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        *hash = fnv1a(*hash, buffer, result);
+        done += result;
+    }
+    return true;
+}
+
+/* hash_source
+ * @brief computes the content key of a source file.
+ * @param source file descriptor of the a.out file.
+ * @param header pointer to the a.out header of the file.
+ * @param text_offset offset of the text section in the file.
+ * @param data_offset offset of the data section in the image (see prepare_image).
+ * @param key set to the content key.
+ *
+ * Returns false if the file could not be read.
+ **/
+static bool hash_source(int source, struct exec *header, unsigned int text_offset,
+    unsigned int data_offset, struct cache_key *key)
+{
+    memset(key, 0, sizeof(struct cache_key));
+    key->magic = N_MAGIC(*header);
+    key->data_offset = data_offset;
+    key->length = header->a_text + header->a_data;
+    key->hash = fnv1a(FNV_OFFSET, header, sizeof(struct exec));
+    return hash_range(source, text_offset, key->length, &key->hash);
+}
+
+/* touch_file
+ * @brief records the use of a cache file for eviction.
+ * @param fd the file.
+ *
+ * @details The access time is set explicitly, because file systems are
+ * usually mounted with noatime or relatime.
+ **/
+static void touch_file(int fd)
+{
+    struct timespec times[2] = { { .tv_nsec = UTIME_NOW }, { .tv_nsec = UTIME_OMIT } };
+    futimens(fd, times);
+}
+
+/* publish_file
+ * @brief writes a file with rename, such that readers never see partial files.
+ * @param cache the image cache.
+ * @param name the name of the file.
+ * @param write_file writes the contents to the temporary file.
+ * @param data passed to write_file.
+ *
+ * Returns false on error.
+ **/
+static bool publish_file(struct image_cache *cache, const char *name, bool (*write_file)(int fd, void *data), void *data)
+{
+    char temporary[NAME_MAX + 1];
+    snprintf(temporary, sizeof(temporary), CACHE_TEMPORARY "%d.%s", getpid(), name);
+    int fd = openat(cache->dir, temporary, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0444);
+    if (fd == -1) {
+        return false;
+    }
+    bool published = write_file(fd, data) && renameat(cache->dir, temporary, cache->dir, name) == 0;
+    int error = errno;
+    close(fd);
+    if (!published) {
+        unlinkat(cache->dir, temporary, 0);
+        errno = error;
+    }
+    return published;
+}
+
+/* write_key_file
+ * @brief writes a key file, see publish_file.
+ * @param fd the temporary file.
+ * @param data the struct cache_key_file.
+ **/
+static bool write_key_file(int fd, void *data)
+{
+    return write(fd, data, sizeof(struct cache_key_file)) == sizeof(struct cache_key_file);
+}
+
+/* find_key
+ * @brief finds the content key of a source file, hashes the source if unknown.
+ * @param cache the image cache.
+ * @param identity the identity of the source file.
+ * @param source file descriptor of the a.out file.
+ * @param header pointer to the a.out header of the file.
+ * @param key set to the content key.
+ *
+ * Returns false if the source could not be read.
+ **/
+static bool find_key(struct image_cache *cache, struct cache_identity *identity, int source,
+    struct exec *header, struct cache_key *key)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx" CACHE_KEY_SUFFIX,
+        (unsigned long long)fnv1a(FNV_OFFSET, identity, sizeof(struct cache_identity)));
+
+    struct cache_key_file file;
+    int fd = openat(cache->dir, name, O_RDONLY | O_CLOEXEC);
+    if (fd != -1) {
+        bool valid = pread(fd, &file, sizeof(file), 0) == sizeof(file)
+            && memcmp(file.magic, CACHE_KEY_MAGIC, sizeof(file.magic)) == 0
+            && memcmp(&file.identity, identity, sizeof(struct cache_identity)) == 0;
+        if (valid) {
+            touch_file(fd);
+        }
+        close(fd);
+        if (valid) {
+            *key = file.key;
+            return true;
+        }
+    }
+
+    if (!hash_source(source, header, identity->text_offset, identity->data_offset, key)) {
+        return false;
+    }
+    memset(&file, 0, sizeof(file));
+    memcpy(file.magic, CACHE_KEY_MAGIC, sizeof(file.magic));
+    file.identity = *identity;
+    file.key = *key;
+    if (!publish_file(cache, name, write_key_file, &file)) {
+        fprintf(logfile, "image cache: cannot publish %s! %s\n", name, strerror(errno));
+    }
+    return true;
+}
+
+/* lookup_entry
+ * @brief opens and verifies a cache entry.
+ * @param cache the image cache.
+ * @param name the name of the entry.
+ * @param key the content key of the source file.
+ * @param size set to the size of the converted image.
+ *
+ * @details Entries which do not belong to key, are truncated or whose image
+ * does not match the digest are removed. Returns a read-only file descriptor
+ * or -1 if there is no valid entry.
+ **/
+static int lookup_entry(struct image_cache *cache, const char *name, struct cache_key *key, off_t *size)
+{
+    int fd = openat(cache->dir, name, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return -1;
+    }
+
+    struct stat st;
+    struct cache_trailer trailer;
+    uint64_t digest = FNV_OFFSET;
+    if (fstat(fd, &st) != 0
+        || st.st_size < (off_t)sizeof(trailer)
+        || pread(fd, &trailer, sizeof(trailer), st.st_size - sizeof(trailer)) != sizeof(trailer)
+        || memcmp(trailer.magic, CACHE_MAGIC, sizeof(trailer.magic)) != 0
+        || memcmp(&trailer.key, key, sizeof(struct cache_key)) != 0
+        || st.st_size != (off_t)(get_aligned_segment_size(trailer.size) + sizeof(trailer))
+        || !hash_range(fd, 0, trailer.size, &digest)
+        || digest != trailer.digest) {
+        fprintf(logfile, "image cache: discarding stale or corrupt entry %s\n", name);
+        close(fd);
+        unlinkat(cache->dir, name, 0);
+        return -1;
+    }
+
+    touch_file(fd);
+    *size = trailer.size;
+    return fd;
+}
+
+// an entry being published, see write_entry.
+struct publication {
+    struct cache_key *key;
+    int source;
+    struct exec *header;
+    unsigned int text_offset;
+    off_t size;
+};
+
+/* write_entry
+ * @brief converts an image into a temporary entry, see publish_file.
+ * @param fd the temporary file.
+ * @param data the struct publication.
+ **/
+static bool write_entry(int fd, void *data)
+{
+    struct publication *publication = data;
+    struct cache_trailer trailer;
+    memset(&trailer, 0, sizeof(trailer));
+    memcpy(trailer.magic, CACHE_MAGIC, sizeof(trailer.magic));
+    trailer.key = *publication->key;
+
+    if (!write_image(publication->source, publication->header, publication->text_offset,
+        publication->key->data_offset, fd, &publication->size)) {
+        return false;
+    }
+    trailer.size = publication->size;
+    trailer.digest = FNV_OFFSET;
+    if (!hash_range(fd, 0, trailer.size, &trailer.digest)) {
+        return false;
+    }
+    off_t offset = get_aligned_segment_size(publication->size);
+    return pwrite(fd, &trailer, sizeof(trailer), offset) == sizeof(trailer);
+}
+
+/* publish_entry
+ * @brief converts an image into a new cache entry.
+ * @param cache the image cache.
+ * @param name the name of the entry.
+ * @param key the content key of the source file.
+ * @param source file descriptor of the a.out file.
+ * @param header pointer to the a.out header of the file.
+ * @param text_offset offset of the text section in the file.
+ * @param size set to the size of the converted image.
+ *
+ * @details Concurrent controllers publishing the same entry produce
+ * identical files. Returns a read-only file descriptor of the entry or -1
+ * on error.
+ **/
+static int publish_entry(struct image_cache *cache, const char *name, struct cache_key *key,
+    int source, struct exec *header, unsigned int text_offset, off_t *size)
+{
+    struct publication publication = {
+        .key = key,
+        .source = source,
+        .header = header,
+        .text_offset = text_offset
+    };
+    if (!publish_file(cache, name, write_entry, &publication)) {
+        return -1;
+    }
+    *size = publication.size;
+
+    // the tracees must not be able to write to the entry.
+    return openat(cache->dir, name, O_RDONLY | O_CLOEXEC);
+}
+
+static int compare_entries(const void *a, const void *b)
+{
+    const struct cache_entry *x = a, *y = b;
+    if (x->used.tv_sec != y->used.tv_sec) {
+        return x->used.tv_sec < y->used.tv_sec ? -1 : 1;
+    }
+    return x->used.tv_nsec < y->used.tv_nsec ? -1 : x->used.tv_nsec > y->used.tv_nsec;
+}
+
+/* has_suffix
+ * @brief returns true if name ends with suffix.
+ * @param name the file name.
+ * @param suffix the suffix.
+ **/
+static bool has_suffix(const char *name, const char *suffix)
+{
+    size_t length = strlen(name);
+    return length >= strlen(suffix) && strcmp(name + length - strlen(suffix), suffix) == 0;
+}
+
+/* evict_entries
+ * @brief removes the least recently used entries until the cache fits its limit.
+ * @param cache the image cache.
+ * @param keep the name of an entry that must not be removed.
+ *
+ * @details Key files are evicted just like entries. Also removes temporary
+ * files left behind by crashed controllers. Entries which are still mapped stay valid until they are unmapped.
+ **/
+static void evict_entries(struct image_cache *cache, const char *keep)
+{
+    int fd = dup(cache->dir);
+    DIR *directory = fd != -1 ? fdopendir(fd) : NULL;
+    if (directory == NULL) {
+        if (fd != -1) {
+            close(fd);
+        }
+        return;
+    }
+    rewinddir(directory);
+
+    struct cache_entry *entries = NULL;
+    int count = 0, capacity = 0;
+    unsigned long total = 0;
+    time_t now = time(NULL);
+    struct dirent *dirent;
+    while ((dirent = readdir(directory)) != NULL) {
+        struct stat st;
+        if (fstatat(cache->dir, dirent->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0 || !S_ISREG(st.st_mode)) {
+            continue;
+        }
+        if (strncmp(dirent->d_name, CACHE_TEMPORARY, strlen(CACHE_TEMPORARY)) == 0) {
+            if (now - st.st_mtime > CACHE_STALE_SECONDS) {
+                unlinkat(cache->dir, dirent->d_name, 0);
+            }
+            continue;
+        }
+        if (!has_suffix(dirent->d_name, CACHE_SUFFIX) && !has_suffix(dirent->d_name, CACHE_KEY_SUFFIX)) {
+            continue;
+        }
+
+        if (count == capacity) {
+            capacity = capacity == 0 ? 16 : capacity * 2;
+            struct cache_entry *resized = realloc(entries, capacity * sizeof(struct cache_entry));
+            if (resized == NULL) {
+                break;
+            }
+            entries = resized;
+        }
+        // holes do not count, only the blocks allocated on disk.
+        struct cache_entry *entry = &entries[count++];
+        snprintf(entry->name, sizeof(entry->name), "%s", dirent->d_name);
+        entry->used = st.st_atim;
+        entry->size = st.st_blocks * 512;
+        total += entry->size;
+    }
+    closedir(directory);
+
+    if (total > cache->limit) {
+        qsort(entries, count, sizeof(struct cache_entry), compare_entries);
+        for (int i = 0; i < count && total > cache->limit; i++) {
+            if (strcmp(entries[i].name, keep) != 0 && unlinkat(cache->dir, entries[i].name, 0) == 0) {
+                fprintf(logfile, "image cache: evicted %s\n", entries[i].name);
+                total -= entries[i].size;
+                cache->evictions++;
+            }
+        }
+    }
+    free(entries);
+}
+
+/* open_image_cache
+ * @brief opens (and creates) a cache directory.
+ * @param cache the image cache to initialize.
+ * @param path the cache directory, its parent must exist.
+ * @param limit the maximum size of the cache in bytes, 0 = CACHE_DEFAULT_LIMIT.
+ *
+ * Returns false if the directory cannot be used, the cache is disabled then.
+ **/
+bool open_image_cache(struct image_cache *cache, const char *path, unsigned long limit)
+{
+    memset(cache, 0, sizeof(struct image_cache));
+    cache->limit = limit != 0 ? limit : CACHE_DEFAULT_LIMIT;
+    if (mkdir(path, 0700) != 0 && errno != EEXIST) {
+        cache->dir = -1;
+        return false;
+    }
+    cache->dir = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    return cache->dir != -1;
+}
+
+/* close_image_cache
+ * @brief closes the cache directory, the entries are kept.
+ * @param cache the image cache.
+ **/
+void close_image_cache(struct image_cache *cache)
+{
+    if (cache->dir != -1) {
+        close(cache->dir);
+        cache->dir = -1;
+    }
+}
+
+/* cached_image
+ * @brief looks up a converted image, converts and publishes it on a miss.
+ * @param cache the image cache.
+ * @param source file descriptor of the a.out file.
+ * @param header pointer to the a.out header of the file.
+ * @param text_offset offset of the text section in the file.
+ * @param data_offset offset of the data section in the image (see prepare_image).
+ * @param image the image to fill.
+ *
+ * Returns false if the cache is disabled or the entry could not be published,
+ * the caller should fall back to prepare_image.
+ **/
+bool cached_image(struct image_cache *cache, int source, struct exec *header,
+    unsigned int text_offset, unsigned int data_offset, struct image *image)
+{
+    // unlinked files, e.g. the memfds of compressed bundle members, have
+    // no stable identity, their key file would never be found again.
+    struct stat st;
+    if (cache->dir == -1 || fstat(source, &st) != 0 || !S_ISREG(st.st_mode) || st.st_nlink == 0) {
+        return false;
+    }
+
+    struct cache_identity identity;
+    memset(&identity, 0, sizeof(identity));
+    identity.dev = st.st_dev;
+    identity.ino = st.st_ino;
+    identity.size = st.st_size;
+    identity.mtime_sec = st.st_mtim.tv_sec;
+    identity.mtime_nsec = st.st_mtim.tv_nsec;
+    identity.ctime_sec = st.st_ctim.tv_sec;
+    identity.ctime_nsec = st.st_ctim.tv_nsec;
+    identity.magic = N_MAGIC(*header);
+    identity.text_offset = text_offset;
+    identity.data_offset = data_offset;
+
+    struct cache_key key;
+    if (!find_key(cache, &identity, source, header, &key)) {
+        return false;
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx" CACHE_SUFFIX, (unsigned long long)fnv1a(FNV_OFFSET, &key, sizeof(key)));
+
+    off_t size;
+    int fd = lookup_entry(cache, name, &key, &size);
+    if (fd != -1) {
+        cache->hits++;
+        fprintf(logfile, "image cache: hit %s\n", name);
+    } else {
+        fd = publish_entry(cache, name, &key, source, header, text_offset, &size);
+        if (fd == -1) {
+            fprintf(logfile, "image cache: cannot publish %s! %s\n", name, strerror(errno));
+            return false;
+        }
+        cache->misses++;
+        fprintf(logfile, "image cache: published %s, size 0x%lx\n", name, (long)size);
+        evict_entries(cache, name);
+    }
+
+    describe_image(fd, header, size, image);
+    return true;
+}
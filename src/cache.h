@@ -0,0 +1,33 @@
+/**
+ * @file cache.h
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief persistent cache of converted a.out images.
+ */
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+#include "a.out.h"
+#include "image.h"
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#define CACHE_DEFAULT_LIMIT (64UL * 1024 * 1024)
+
+struct image_cache {
+    int dir;             /* file descriptor of the cache directory or -1 */
+    unsigned long limit; /* maximum size of all entries in bytes */
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long evictions;
+};
+
+bool open_image_cache(struct image_cache *cache, const char *path, unsigned long limit);
+void close_image_cache(struct image_cache *cache);
+bool cached_image(struct image_cache *cache, int source, struct exec *header,
+    unsigned int text_offset, unsigned int data_offset, struct image *image);
+
+#endif
@@ -17,7 +17,7 @@
  **/
 void print_aout_header(struct exec *header)
 {
-	fprintf(logfile, "header size: %d\n", sizeof(struct exec));
+	fprintf(logfile, "header size: %zu\n", sizeof(struct exec));
 	fprintf(logfile, "magic		: 0x%x\n", N_MAGIC(*header));
 	fprintf(logfile, "machine		: 0x%x\n", N_MACHTYPE(*header));
 	fprintf(logfile, "flags		: 0x%x\n", N_FLAGS(*header));
@@ -30,6 +30,29 @@ void print_aout_header(struct exec *header)
 	fprintf(logfile, "sizeof(drel): 0x%1$x (%1$d)\n", header->a_drsize);
 }
 
+/* print_symbol
+ * @brief for_each_symbol callback of print_aout_symbols.
+ **/
+static void print_symbol(const struct nlist *symbol, const char *name, void *data)
+{
+	(void)data;
+	fprintf(logfile, "0x%08x 0x%02x %s\n", symbol->n_value, symbol->n_type, name != NULL ? name : "?");
+}
+
+/* print_aout_symbols
+ * @brief prints the symbol table and the number of relocations of an a.out file.
+ * @param object the a.out object.
+ **/
+void print_aout_symbols(struct aout_object *object)
+{
+	unsigned int text_relocations, data_relocations;
+	object_relocations(object, TEXT_RELOCATIONS, &text_relocations);
+	object_relocations(object, DATA_RELOCATIONS, &data_relocations);
+	fprintf(logfile, "relocations : %u text, %u data\n", text_relocations, data_relocations);
+	fprintf(logfile, "symbols     : %u\n", object->nsymbols);
+	for_each_symbol(object, print_symbol, NULL);
+}
+
 /* print_user_regs
  * @brief prints all registers given by regs
  * @param regs pointer to the user_regs_struct to be printed.
@@ -49,14 +72,19 @@ void print_user_regs(struct user_regs_struct *regs)
  **/
 void pprint_memory(pid_t pid, unsigned long addr, int count)
 {
-    long value;
+    unsigned int values[count];
+    unsigned long start = addr - (count / 2) * 4;
+    ssize_t r = read_memory(pid, start, values, count * 4);
     for (int i = -(count / 2); i < count / 2; i++) {
         if (i % 4 == 0)
             fprintf(logfile, "\n0x%08lx:\t", addr + i * 4);
         else
             fprintf(logfile, "\t");
-        value = ptrace(PTRACE_PEEKDATA, pid, addr + i * 4, NULL);
-        fprintf(logfile, "0x%08lx", value);
+        int index = i + count / 2;
+        if (r >= (index + 1) * 4)
+            fprintf(logfile, "0x%08x", values[index]);
+        else
+            fprintf(logfile, "??????????");
     }
 }
 
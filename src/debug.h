@@ -17,11 +17,14 @@
 
 #include "a.out.h"
 #include "run-aout.h"
+#include "memory.h"
+#include "object.h"
 
 #ifndef DEBUG_H
 #define DEBUG_H
 
 void print_aout_header(struct exec *header);
+void print_aout_symbols(struct aout_object *object);
 void print_user_regs(struct user_regs_struct *regs);
 void pprint_memory(pid_t pid, unsigned long addr, int count);
 bool validate_header(struct exec *header);
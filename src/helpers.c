@@ -11,53 +11,73 @@
 
 #include "helpers.h"
 
-union long_char {
-    long value;
-    char chars[sizeof(long)];
-};
+/* set_breakpoint
+ * @brief patches an int3 instruction at the given address.
+ * @param pid the PID of the process to be accessed.
+ * @param address the address of the instruction to stop at.
+ *
+ * Returns the original data at address, which must be passed to clear_breakpoint.
+ **/
+long set_breakpoint(pid_t pid, unsigned long address)
+{
+    long original = ptrace(PTRACE_PEEKTEXT, pid, address, NULL);
+    ptrace(PTRACE_POKETEXT, pid, address, (original & ~0xffL) | 0xcc);
+    return original;
+}
 
-/* wait_for_syscall
- * @brief waits for a syscall.
+/* clear_breakpoint
+ * @brief restores the instruction replaced by set_breakpoint.
  * @param pid the PID of the process to be accessed.
- * @param syscall the number of the system call to be intercepted.
+ * @param address the address of the breakpoint.
+ * @param original the value returned by set_breakpoint.
  **/
-bool wait_for_syscall(pid_t pid, int syscall)
+void clear_breakpoint(pid_t pid, unsigned long address, long original)
+{
+    ptrace(PTRACE_POKETEXT, pid, address, original);
+}
+
+/* run_to_address
+ * @brief resumes the process until it reaches the given address.
+ * @param pid the PID of the process to be accessed.
+ * @param address the address of the instruction to stop at.
+ *
+ * @details Temporarily patches an int3 instruction at address and lets
+ * the process run at full speed instead of single-stepping to it. Once
+ * the breakpoint is hit, the original instruction is restored and EIP
+ * is reset to address, such that the process is stopped right before
+ * executing the instruction. Signals received in the meantime are forwarded.
+ * NOTE: a group-stop in the meantime is not kept, the process keeps running.
+ * Returns the status of the last stop.
+ **/
+int run_to_address(pid_t pid, unsigned long address)
 {
-    int status = 0;
     struct user_regs_struct regs;
-  
+    int signal = 0;
+    int status = 0;
+
+    long original = set_breakpoint(pid, address);
+
     while (true) {
-        fprintf(logfile, "PTRACE_SYSCALL with signal %d\n", WSTOPSIG(status));
-        // HACK: forward SIGALRM to child to make ping work...
-        // TODO: are there any other places and/or signals that need adjustment?
-        if (WSTOPSIG(status) == SIGALRM) {
-            ptrace(PTRACE_SYSCALL, pid, NULL, (void *)WSTOPSIG(status));
-        } else {
-            ptrace(PTRACE_SYSCALL, pid, NULL, NULL);
-        }
-        status = waitpid_printf(pid);
-        int isStop = WSTOPSIG(status) & 0x80;
-        if (WIFSTOPPED(status) && isStop) {
+        ptrace(PTRACE_CONT, pid, NULL, (void *)signal);
+        if (waitpid_printf(pid, &status) == -1 || !WIFSTOPPED(status))
+            break;
+        signal = WSTOPSIG(status);
+        if ((status >> 16) != 0) {
+            // event-stop (e.g. group-stop): there is no signal to deliver.
+            signal = 0;
+        } else if (signal == SIGTRAP) {
             ptrace(PTRACE_GETREGS, pid, NULL, &regs);
-            fprintf(logfile, "seeing syscall %ld\n", regs.orig_eax);
-            if (regs.orig_eax == syscall) {
-                fprintf(logfile, "syscall eax: 0x%lx\n", regs.eax);
-                print_data(pid, regs.ebx, 1024);
-                return true;
-            }
-            if (regs.orig_eax == SYS_exit) {
-                // code for debugging: print pmap at exit
-                //char buf[100];
-                //sprintf(buf, "pmap %d", pid);
-                //printf(buf);
-                //system(buf);
-                getchar();
+            if ((unsigned long)regs.eip == address + 1) {
+                regs.eip = address;
+                ptrace(PTRACE_SETREGS, pid, NULL, &regs);
+                break;
             }
+            signal = 0;
         }
-        if (WIFEXITED(status))
-            return false;
     }
-    return false;
+
+    clear_breakpoint(pid, address, original);
+    return status;
 }
 
 /* get_aligned_segment_size
@@ -77,21 +97,38 @@ long get_aligned_segment_size(long segment_size)
 }
 
 /* strlast
- * @brief returns the part of s after last occurrence of delimiter or null if not found.
+ * @brief returns the part of s after the last occurrence of any character of delimiter.
  * @param s the string to operate on
- * @param delimiter the delimiter to look for.
+ * @param delimiter the delimiters to look for.
+ *
+ * @details Returns s if there is no delimiter. The result points into s,
+ * nothing is allocated.
  **/
 char *strlast(char *s, const char *delimiter)
 {
-    char *save, *curr, *prev;
-    prev = NULL;
-    s = strdup(s);
-    curr = strtok_r(s, delimiter, &save);
-    while (curr != NULL) {
-        prev = curr;
-        curr = strtok_r(NULL, delimiter, &save);
+    char *last = s;
+    for (char *current = s; *current != '\0'; current++) {
+        if (strchr(delimiter, *current) != NULL) {
+            last = current + 1;
+        }
     }
-    return prev;
+    return last;
+}
+
+/* is_aout_header
+ * @brief returns true if N_MAGIC is any of OMAGIC, NMAGIC, ZMAGIC or QMAGIC.
+ * @param header pointer to the a.out header
+ *
+ * @details Unlike validate_header, this does not print anything, thus it
+ * can be used to tell a.out files apart from other executables.
+ **/
+bool is_aout_header(struct exec *header)
+{
+	unsigned int magic = N_MAGIC(*header);
+	return magic == MAGIC_OMAGIC
+        || magic == MAGIC_NMAGIC
+        || magic == MAGIC_ZMAGIC
+        || magic == MAGIC_QMAGIC;
 }
 
 /* validate_header
@@ -104,12 +141,7 @@ char *strlast(char *s, const char *delimiter)
  **/
 bool validate_header(struct exec *header)
 {
-	unsigned int magic = N_MAGIC(*header);
-	if (magic != MAGIC_OMAGIC
-        && magic != MAGIC_NMAGIC
-        && magic != MAGIC_ZMAGIC
-        && magic != MAGIC_QMAGIC)
-    {
+	if (!is_aout_header(header)) {
 		fprintf(stderr, "Error: Unsupported executable format: expected OMAGIC (0x107), NMAGIC (0x108), ZMAGIC (0x10b) or QMAGIC (0xcc), got 0x%x.\n", N_MAGIC(*header));
 		return false;
 	}
@@ -127,99 +159,97 @@ bool validate_header(struct exec *header)
 	return true;
 }
 
-/* get_data
- * @brief reads data from process memory.
- * @param pid the PID of the process to access.
- * @param address the address to read from.
- * @param buffer non-NULL buffer to write to.
- * @param length the number of quadlets (32-bit) to read.
- **/
-void get_data(pid_t pid, long address, char *buffer, int length)
-{
-    union long_char data;
-    
-    for (int i = 0; i < length; i += sizeof(long)) {
-        data.value = ptrace(PTRACE_PEEKDATA, pid, address + i, NULL);
-        int rem = length - i;
-        memcpy(buffer + i, data.chars, rem < sizeof(long) ? rem : sizeof(long));
-    }
-    buffer[length] = '\0';
-}
-
 /* set_data
- * @brief writes data to process memory.
+ * @brief writes data to process memory below the stack pointer.
  * @param pid the PID of the process to access.
  * @param buffer non-NULL buffer to read from.
- * @param length the number of quadlets (32-bit) to write.
+ * @param length the number of bytes to write.
  * 
  * Returns the address of the written data.
  **/
 long set_data(pid_t pid, char *buffer, int length)
 {
-    union long_char data;
-
     struct user_regs_struct regs;
     ptrace(PTRACE_GETREGS, pid, NULL, &regs);
 
-    char *stack = (char *)regs.esp;
-    stack -= 128 + PATH_MAX;
-
-    for (int i = 0; i < length; i += sizeof(long)) {
-        int rem = length - i;
-        memcpy(&data.chars, buffer + i, rem < sizeof(long) ? rem : sizeof(long));
-        ptrace(PTRACE_POKEDATA, pid, stack + i, data.value);
-    }
+    unsigned long stack = regs.esp - (128 + PATH_MAX);
+    write_memory(pid, stack, buffer, length);
 
     return (long)stack;
 }
 
 /* print_data
- * @brief reads data from process memory and prints it to the logfile.
+ * @brief reads a string from process memory and prints it to the logfile.
  * @param pid the PID of the process to access.
  * @param address the address to read from.
- * @param length the number of quadlets (32-bit) to read.
+ * @param length the maximum number of bytes to read.
  **/
 void print_data(pid_t pid, long address, int length)
 {
     char buffer[1024];
-    get_data(pid, address, buffer, length);
+    read_string(pid, address, buffer, length < (int)sizeof(buffer) ? length : (int)sizeof(buffer));
     fprintf(logfile, "data at 0x%08lx: \"%s\"\n", address, buffer);
 }
 
 /* waitpid_printf
  * @brief waits for pid to be signalled and then prints status information.
- * @param pid the PID to wait for.
+ * @param pid the PID to wait for, -1 for any child or tracee or -PGID for a process group.
+ * @param status non-NULL pointer to store the status.
  * 
- * Returns the status.
+ * @details Unless pid is a single process, returns early with -1 and
+ * errno = EINTR if the controller is interrupted by a signal.
+ * Returns the PID of the process or -1 on error.
  **/
-int waitpid_printf(pid_t pid)
+pid_t waitpid_printf(pid_t pid, int *status_ptr)
 {
     int status;
-    waitpid(pid, &status, 0);
+    pid_t result;
+    do {
+        result = waitpid(pid, &status, __WALL);
+    } while (result == -1 && errno == EINTR && pid > 0);
+    if (result == -1) {
+        return -1;
+    }
+    pid = result;
+    *status_ptr = status;
 
     if (WIFSTOPPED(status)) {
         fprintf(logfile, "a.out host %d stopped: %d = %s\n", pid, WSTOPSIG(status), strsignal(WSTOPSIG(status)));
-        if (WSTOPSIG(status) == SIGSEGV) {
+        // not fatal, unless the a.out program does not handle it.
+        if (WSTOPSIG(status) == SIGSEGV && (status >> 16) == 0) {
             print_pc(pid);
             print_regs(pid);
-            exit(1);
-        } else {
-
         }
     }
     if (WIFEXITED(status)) {
         fprintf(logfile, "a.out host %d exited: %d\n", pid, WEXITSTATUS(status));
-        exit(WEXITSTATUS(status));
     }
     if (WIFSIGNALED(status)) {
         fprintf(logfile, "a.out host %d signaled: %d = %s\n", pid, WTERMSIG(status), strsignal(WTERMSIG(status)));
-        if (WTERMSIG(status) == SIGKILL) {
-            exit(1);
+        if (WCOREDUMP(status)) {
+            fprintf(logfile, "a.out host %d: Core dumped.\n", pid);
         }
     }
-    if (WCOREDUMP(status)) {
-        fprintf(logfile, "a.out host %d: Core dumped.\n", pid);
-    }
 
-    return status;
+    return pid;
+}
+
+/* start_thread
+ * @brief starts a helper thread of the controller.
+ * @param thread the thread to start.
+ * @param function the thread function.
+ * @param data the argument of function.
+ *
+ * @details All signals are blocked in the thread, they are handled by the
+ * thread calling runaout_wait (e.g. SIGALRM must interrupt its waitpid).
+ * Returns 0 or an error number.
+ **/
+int start_thread(pthread_t *thread, void *(*function)(void *), void *data)
+{
+    sigset_t all, previous;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &previous);
+    int error = pthread_create(thread, NULL, function, data);
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+    return error;
 }
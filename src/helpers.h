@@ -11,6 +11,7 @@
 #include <string.h>
 #include <unistd.h>
 #include <limits.h>
+#include <errno.h>
 
 #include <sys/ptrace.h>
 #include <sys/types.h>
@@ -18,23 +19,28 @@
 #include <sys/reg.h>
 #include <sys/syscall.h>
 #include <signal.h>
+#include <pthread.h>
 #include <wait.h>
 #include <syscall.h>
 
 #include "a.out.h"
 #include "run-aout.h"
 #include "debug.h"
+#include "memory.h"
 
 #ifndef HELPERS_H
 #define HELPERS_H
 
-bool wait_for_syscall(pid_t pid, int syscall);
+long set_breakpoint(pid_t pid, unsigned long address);
+void clear_breakpoint(pid_t pid, unsigned long address, long original);
+int run_to_address(pid_t pid, unsigned long address);
 long get_aligned_segment_size(long segment_size);
 char *strlast(char *s, const char *delimiter);
+bool is_aout_header(struct exec *header);
 bool validate_header(struct exec *header);
-void get_data(pid_t pid, long address, char *buffer, int length);
 long set_data(pid_t pid, char *buffer, int length);
 void print_data(pid_t pid, long address, int length);
-int waitpid_printf(pid_t pid);
+pid_t waitpid_printf(pid_t pid, int *status);
+int start_thread(pthread_t *thread, void *(*function)(void *), void *data);
 
 #endif
\ No newline at end of file
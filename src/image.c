@@ -0,0 +1,369 @@
+/**
+ * @file image.c
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief conversion of ZMAGIC, OMAGIC and NMAGIC files into mappable images.
+ *
+ * @details The sections are copied inside the kernel (copy_file_range, then
+ * sendfile) and only if neither is supported through a user space buffer.
+ * Images are sealed memfd files, thus nothing is written to the file system
+ * and concurrent launches cannot interfere. Padding is never written, it is
+ * a hole of the image, and bss is mapped as anonymous memory.
+ */
+
+#define _GNU_SOURCE // copy_file_range
+
+#undef __x86_64__ // undefine x86_64 env to make vscode
+				  // use 32-bit header files
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+
+#include "image.h"
+#include "helpers.h"
+
+#define COPY_BUFFER_SIZE (256 * 1024)
+
+/* is_unsupported
+ * @brief returns true if errno indicates that a copy method is not
+ * available for the given files, such that the next one should be tried.
+ **/
+static bool is_unsupported()
+{
+    return errno == ENOSYS || errno == EXDEV || errno == EINVAL
+        || errno == EOPNOTSUPP || errno == EBADF;
+}
+
+/* copy_range
+ * @brief copies length bytes from source at offset to target at target_offset.
+ * @param source the file to read from.
+ * @param offset the offset in source.
+ * @param target the file to write to, the file position may change.
+ * @param target_offset the offset in target.
+ * @param length the number of bytes to copy.
+ *
+ * @details Returns false if the copy failed, e.g. because source ends
+ * before offset + length (errno is set to ENOEXEC in this case).
+ **/
+bool copy_range(int source, off_t offset, int target, off_t target_offset, size_t length)
+{
+    // 1. in the kernel, file systems may even share the extents.
+    while (length > 0) {
+        loff_t in = offset, out = target_offset;
+        ssize_t n = copy_file_range(source, &in, target, &out, length, 0);
+        if (n > 0) {
+            length -= n;
+            offset += n;
+            target_offset += n;
+        } else if (n == 0) {
+            errno = ENOEXEC;
+            return false;
+        } else if (errno != EINTR) {
+            break;
+        }
+    }
+    if (length == 0) {
+        return true;
+    }
+    if (!is_unsupported()) {
+        return false;
+    }
+
+    // 2. in the kernel, through the page cache.
+    if (lseek(target, target_offset, SEEK_SET) == target_offset) {
+        while (length > 0) {
+            ssize_t n = sendfile(target, source, &offset, length);
+            if (n > 0) {
+                length -= n;
+                target_offset += n;
+            } else if (n == 0) {
+                errno = ENOEXEC;
+                return false;
+            } else if (errno != EINTR) {
+                break;
+            }
+        }
+        if (length == 0) {
+            return true;
+        }
+        if (!is_unsupported()) {
+            return false;
+        }
+    }
+
+    // 3. through a buffer.
+    char *buffer = malloc(COPY_BUFFER_SIZE);
+    if (buffer == NULL) {
+        return false;
+    }
+    while (length > 0) {
+        ssize_t r = pread(source, buffer, length < COPY_BUFFER_SIZE ? length : COPY_BUFFER_SIZE, offset);
+        if (r == -1 && errno == EINTR) {
+            continue;
+        }
+        if (r <= 0) {
+            if (r == 0) {
+                errno = ENOEXEC;
+            }
+            break;
+        }
+        for (ssize_t written = 0; written < r; ) {
+            ssize_t w = pwrite(target, buffer + written, r - written, target_offset + written);
+            if (w == -1 && errno == EINTR) {
+                continue;
+            }
+            if (w <= 0) {
+                free(buffer);
+                return false;
+            }
+            written += w;
+        }
+        offset += r;
+        target_offset += r;
+        length -= r;
+    }
+    free(buffer);
+    return length == 0;
+}
+
+/* set_bss
+ * @brief sets the anonymous bss mapping following the file mapping.
+ * @param image the image with start set.
+ * @param data_end load address of the end of the data section.
+ * @param bss the size of the bss section.
+ *
+ * @details The file mapping ends at the next page boundary, bytes after the
+ * end of the file in its last page are zero, thus only whole pages of the
+ * bss section need to be mapped.
+ **/
+static void set_bss(struct image *image, unsigned int data_end, unsigned int bss)
+{
+    image->length = get_aligned_segment_size(data_end - image->start);
+    image->bss_start = image->start + image->length;
+    unsigned int bss_end = image->start + get_aligned_segment_size(data_end + bss - image->start);
+    image->bss_length = bss_end > image->bss_start ? bss_end - image->bss_start : 0;
+}
+
+/* qmagic_image
+ * @brief describes a QMAGIC file, which can be mapped as is.
+ * @param fd file descriptor of the a.out executable.
+ * @param header pointer to the a.out header of the image.
+ * @param image the image to fill.
+ **/
+void qmagic_image(int fd, struct exec *header, struct image *image)
+{
+    memset(image, 0, sizeof(struct image));
+    image->fd = fd;
+    image->start = header->a_entry & 0xfffff000;
+    image->entry = header->a_entry;
+    image->text_length = get_aligned_segment_size(header->a_text);
+    set_bss(image, image->start + get_aligned_segment_size(header->a_text)
+        + get_aligned_segment_size(header->a_data), header->a_bss);
+}
+
+/* get_data_start
+ * @brief returns the offset of the data section in a converted image.
+ * @param header pointer to the a.out header of the image.
+ * @param data_offset offset of the data section in the image (or 0 if no alignment is needed).
+ **/
+static unsigned int get_data_start(struct exec *header, unsigned int data_offset)
+{
+    // the data section follows the text section, unless it must be aligned.
+    return data_offset > header->a_text ? data_offset : header->a_text;
+}
+
+/* describe_image
+ * @brief describes a converted image, i.e. text at offset 0 of the file.
+ * @param fd file descriptor of the converted image.
+ * @param header pointer to the a.out header of the executable.
+ * @param size size of the converted image as returned by write_image.
+ * @param image the image to fill.
+ *
+ * @details The text section is read-only, except for OMAGIC files and a page
+ * that text shares with data.
+ **/
+void describe_image(int fd, struct exec *header, off_t size, struct image *image)
+{
+    memset(image, 0, sizeof(struct image));
+    image->fd = fd;
+    image->start = header->a_entry & 0xfffff000;
+    image->entry = header->a_entry;
+    if (N_MAGIC(*header) != MAGIC_OMAGIC) {
+        image->text_length = (size - header->a_data) & 0xfffff000;
+    }
+    set_bss(image, image->start + size, header->a_bss);
+}
+
+/* lazy_image
+ * @brief describes a non-QMAGIC image without converting it.
+ * @param source file descriptor of the a.out file.
+ * @param header pointer to the a.out header of the image.
+ * @param text_offset offset of the text section in the image.
+ * @param data_offset offset of the data section in the image (or 0 if no alignment is needed).
+ * @param image the image to fill.
+ *
+ * @details The layout is the one write_image would produce, the pages are
+ * copied from the a.out file on first access (see lazy.c) or read by the
+ * trampoline, if it cannot create a userfaultfd (see _read_lazy).
+ **/
+void lazy_image(int source, struct exec *header, unsigned int text_offset, unsigned int data_offset, struct image *image)
+{
+    unsigned int data_start = get_data_start(header, data_offset);
+    describe_image(source, header, data_start + header->a_data, image);
+    image->lazy = true;
+    image->data_start = data_start;
+    // the region is filled by the controller, it must stay writable.
+    image->text_length = 0;
+    image->text_offset = text_offset;
+    image->text_size = header->a_text;
+    image->data_size = header->a_data;
+}
+
+/* write_image
+ * @brief copies the sections of a non-QMAGIC a.out file to the "correct" locations.
+ * @param source file descriptor of the a.out image to be loaded.
+ * @param header pointer to the a.out header of the image.
+ * @param text_offset offset of the text section in the image.
+ * @param data_offset offset of the data section in the image (or 0 if no alignment is needed).
+ * @param target the (empty) file to write the converted image to.
+ * @param size set to the size of the converted image.
+ *
+ * @details The padding between text and data (NMAGIC) is left as a hole,
+ * which reads as zeros. Returns false on error.
+ **/
+bool write_image(int source, struct exec *header, unsigned int text_offset, unsigned int data_offset, int target, off_t *size)
+{
+    off_t data_start = get_data_start(header, data_offset);
+    *size = data_start + header->a_data;
+
+    return copy_range(source, text_offset, target, 0, header->a_text)
+        && copy_range(source, text_offset + header->a_text, target, data_start, header->a_data)
+        && ftruncate(target, *size) == 0;
+}
+
+/* create_image_file
+ * @brief creates an anonymous file for an image, which can be sealed.
+ *
+ * @details Every image gets its own file, because images of earlier
+ * (exec'ed) processes or concurrent launches may still be mapped.
+ **/
+static int create_image_file()
+{
+    int fd = memfd_create("aout-image", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd == -1) {
+        fprintf(stderr, "Error: cannot create image file! %s\n", strerror(errno));
+    }
+    return fd;
+}
+
+/* seal_image_file
+ * @brief seals an image file once it is written.
+ * @param fd the image file.
+ *
+ * @details The tracees map the image privately, sealing it guarantees
+ * that it does not change underneath them.
+ **/
+static bool seal_image_file(int fd)
+{
+    return fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) == 0;
+}
+
+/* extract_image
+ * @brief copies a QMAGIC file out of an archive, if it cannot be mapped in place.
+ * @param source file descriptor of the archive.
+ * @param offset offset of the member in the archive.
+ * @param size size of the member.
+ *
+ * Returns the file descriptor of a sealed copy or -1 on error.
+ **/
+int extract_image(int source, off_t offset, off_t size)
+{
+    int target = create_image_file();
+    if (target == -1) {
+        return -1;
+    }
+    if (!copy_range(source, offset, target, 0, size) || !seal_image_file(target)) {
+        fprintf(stderr, "Error: cannot extract image! %s\n", strerror(errno));
+        close(target);
+        return -1;
+    }
+    fprintf(logfile, "extracted image: offset 0x%lx, size 0x%lx\n", (long)offset, (long)size);
+    return target;
+}
+
+/* pending_image
+ * @brief describes a non-QMAGIC image, which is converted later on.
+ * @param header pointer to the a.out header of the image.
+ * @param text_offset offset of the text section in the image.
+ * @param data_offset offset of the data section in the image (or 0 if no alignment is needed).
+ * @param image the image to fill.
+ *
+ * @details image->fd is an empty memfd, which can already be handed to the
+ * trampoline, complete_image converts the image into it. Returns false on error.
+ **/
+bool pending_image(struct exec *header, unsigned int text_offset, unsigned int data_offset, struct image *image)
+{
+    int target = create_image_file();
+    if (target == -1) {
+        return false;
+    }
+    unsigned int data_start = get_data_start(header, data_offset);
+    describe_image(target, header, data_start + header->a_data, image);
+    image->pending = true;
+    image->data_start = data_start;
+    image->text_offset = text_offset;
+    return true;
+}
+
+/* complete_image
+ * @brief converts a pending image (see pending_image).
+ * @param source file descriptor of the a.out image to be loaded.
+ * @param header pointer to the a.out header of the image.
+ * @param image the pending image.
+ *
+ * @details The image is sealed afterwards. Returns false on error.
+ **/
+bool complete_image(int source, struct exec *header, struct image *image)
+{
+    off_t size;
+    if (!write_image(source, header, image->text_offset, image->data_start, image->fd, &size)
+        || !seal_image_file(image->fd)) {
+        fprintf(stderr, "Error: cannot convert image! %s\n", strerror(errno));
+        return false;
+    }
+
+    image->pending = false;
+    fprintf(logfile, "converted image: text 0x%x, data 0x%x, size 0x%lx, bss 0x%x at 0x%x\n",
+        header->a_text, header->a_data, (long)size, image->bss_length, image->bss_start);
+    return true;
+}
+
+/* prepare_image
+ * @brief prepares a non-QMAGIC a.out image for execution.
+ * @param source file descriptor of the a.out image to be loaded.
+ * @param header pointer to the a.out header of the image.
+ * @param text_offset offset of the text section in the image.
+ * @param data_offset offset of the data section in the image (or 0 if no alignment is needed).
+ * @param image the image to fill.
+ *
+ * @details converts the image into a sealed memfd (see write_image).
+ * Returns false on error.
+ **/
+bool prepare_image(int source, struct exec *header, unsigned int text_offset, unsigned int data_offset, struct image *image)
+{
+    if (!pending_image(header, text_offset, data_offset, image)) {
+        return false;
+    }
+    if (!complete_image(source, header, image)) {
+        close(image->fd);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file image.h
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief conversion of ZMAGIC, OMAGIC and NMAGIC files into mappable images.
+ */
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+#include "a.out.h"
+
+#ifndef IMAGE_H
+#define IMAGE_H
+
+// an image ready to be mapped by the trampoline (see struct trampoline_params).
+struct image {
+    int fd;                  /* file descriptor of the image */
+    unsigned int start;      /* load address of the text section */
+    unsigned int length;     /* page aligned size of the file mapping */
+    unsigned int text_length; /* page aligned size of the read-only part or 0 (see trampoline_params) */
+    unsigned int offset;     /* page aligned offset of the image in the file */
+    unsigned int bss_start;  /* page aligned start of the anonymous bss */
+    unsigned int bss_length; /* page aligned size of the anonymous bss or 0 */
+    unsigned int entry;      /* entry point of the a.out executable */
+    bool lazy;               /* fd is the a.out file, the pages are filled on first access */
+    bool pending;            /* fd is an empty memfd, see complete_image */
+    unsigned int text_offset; /* lazy and pending images: offset of the text section in the a.out file */
+    unsigned int data_start;  /* lazy and pending images: offset of the data section in the image */
+    unsigned int text_size;   /* lazy images: size of the text section */
+    unsigned int data_size;   /* lazy images: size of the data section */
+};
+
+bool copy_range(int source, off_t offset, int target, off_t target_offset, size_t length);
+void qmagic_image(int fd, struct exec *header, struct image *image);
+void describe_image(int fd, struct exec *header, off_t size, struct image *image);
+void lazy_image(int source, struct exec *header, unsigned int text_offset, unsigned int data_offset, struct image *image);
+bool write_image(int source, struct exec *header, unsigned int text_offset, unsigned int data_offset, int target, off_t *size);
+int extract_image(int source, off_t offset, off_t size);
+bool pending_image(struct exec *header, unsigned int text_offset, unsigned int data_offset, struct image *image);
+bool complete_image(int source, struct exec *header, struct image *image);
+bool prepare_image(int source, struct exec *header, unsigned int text_offset, unsigned int data_offset, struct image *image);
+
+#endif
@@ -0,0 +1,336 @@
+/**
+ * @file lazy.c
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief userfaultfd based lazy loading of non-QMAGIC images.
+ *
+ * @details Instead of converting the whole image before the first instruction
+ * runs, the trampoline maps an empty region and registers it with a
+ * userfaultfd (see _map_lazy). The controller takes the userfaultfd with
+ * pidfd_getfd and a thread fills every page on its first access, straight
+ * from the a.out file, using the layout write_image would produce.
+ * The thread never uses ptrace, the tracer thread is not involved.
+ * Forked children do not inherit the registration, their copy is filled
+ * completely when the fork is reported (UFFD_FEATURE_EVENT_FORK).
+ * If the trampoline cannot create or register a userfaultfd for any
+ * reason, it reads the sections into the region itself (see _read_lazy).
+ */
+
+#define _GNU_SOURCE
+
+#undef __x86_64__ // undefine x86_64 env to make vscode
+				  // use 32-bit header files
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/userfaultfd.h>
+
+#include "lazy.h"
+#include "params.h"
+#include "helpers.h"
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+#ifndef SYS_pidfd_getfd
+#define SYS_pidfd_getfd 438
+#endif
+
+struct lazy_loader {
+    pthread_t thread;
+    pid_t pid;
+    int pidfd;
+    int source;    /* the a.out file */
+    int ready_fd;  /* end of file once the trampoline has registered the region */
+    int ack_fd;    /* the parameter pipe, written once the userfaultfd is taken */
+    int stop[2];   /* closed by finish_lazy_loader */
+    struct exec header;
+    struct image image;
+    unsigned long faults;
+};
+
+/* userfaultfd
+ * @brief creates a userfaultfd.
+ *
+ * @details UFFD_USER_MODE_ONLY must not be used: system calls of the
+ * a.out program, which access a page first, would fail with EFAULT
+ * instead of waiting for the page (e.g. read into .bss or uselib of
+ * a name in .data).
+ **/
+static int userfaultfd()
+{
+    return syscall(SYS_userfaultfd, O_CLOEXEC | O_NONBLOCK);
+}
+
+/* lazy_loading_available
+ * @brief checks whether this process may use userfaultfd with fork events.
+ *
+ * @details The trampoline runs with the same credentials. Without fork
+ * events (they require CAP_SYS_PTRACE), forked children would see zeros
+ * instead of the pages not accessed before the fork.
+ **/
+bool lazy_loading_available()
+{
+    int fd = userfaultfd();
+    if (fd == -1) {
+        return false;
+    }
+    struct uffdio_api api = { .api = UFFD_API, .features = UFFD_FEATURE_EVENT_FORK };
+    bool available = ioctl(fd, UFFDIO_API, &api) == 0;
+    close(fd);
+    return available;
+}
+
+/* read_section
+ * @brief copies the part of a section that lies within a page.
+ * @param loader the lazy loader.
+ * @param offset offset of the page in the image.
+ * @param page the page buffer.
+ * @param section_start offset of the section in the image.
+ * @param section_size size of the section.
+ * @param file_offset offset of the section in the a.out file.
+ *
+ * Returns false with errno set, if the a.out file could not be read (EIO if it is truncated).
+ **/
+static bool read_section(struct lazy_loader *loader, unsigned int offset, char *page,
+    unsigned int section_start, unsigned int section_size, off_t file_offset)
+{
+    unsigned int from = offset > section_start ? offset : section_start;
+    unsigned int to = offset + PAGE_SIZE < section_start + section_size ? offset + PAGE_SIZE : section_start + section_size;
+    while (from < to) {
+        ssize_t result = pread(loader->source, page + (from - offset), to - from, file_offset + (from - section_start));
+        if (result == -1 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            if (result == 0) {
+                errno = EIO;
+            }
+            return false;
+        }
+        from += result;
+    }
+    return true;
+}
+
+/* fill_page
+ * @brief copies a page of the image into a tracee.
+ * @param loader the lazy loader.
+ * @param uffd the userfaultfd of the tracee.
+ * @param address the page aligned address.
+ *
+ * @details If the a.out file cannot be read, the tracee is killed instead
+ * of running on a corrupt page. Returns false if the page could not be
+ * copied, e.g. because the tracee exited.
+ **/
+static bool fill_page(struct lazy_loader *loader, int uffd, unsigned int address)
+{
+    static __thread char page[PAGE_SIZE];
+    unsigned int offset = address - loader->image.start;
+    memset(page, 0, PAGE_SIZE);
+    if (!read_section(loader, offset, page, 0, loader->header.a_text, loader->image.text_offset)
+        || !read_section(loader, offset, page, loader->image.data_start, loader->header.a_data,
+            loader->image.text_offset + loader->header.a_text)) {
+        fprintf(logfile, "Error: cannot read page 0x%08x of pid %d! %s\n", address, loader->pid, strerror(errno));
+        kill(loader->pid, SIGKILL);
+        return false;
+    }
+
+    struct uffdio_copy copy = {
+        .dst = address,
+        .src = (uintptr_t)page,
+        .len = PAGE_SIZE,
+        .mode = 0
+    };
+    while (ioctl(uffd, UFFDIO_COPY, &copy) != 0) {
+        // EEXIST: the page is already present.
+        if (errno != EAGAIN) {
+            return errno == EEXIST;
+        }
+    }
+    return true;
+}
+
+/* fill_all
+ * @brief copies all pages that have not been accessed yet.
+ * @param loader the lazy loader.
+ * @param uffd the userfaultfd of the tracee.
+ **/
+static void fill_all(struct lazy_loader *loader, int uffd)
+{
+    unsigned int end = loader->image.start + loader->image.length;
+    for (unsigned int address = loader->image.start; address < end; address += PAGE_SIZE) {
+        if (!fill_page(loader, uffd, address)) {
+            break;
+        }
+    }
+}
+
+/* take_userfaultfd
+ * @brief waits until the trampoline has registered the region and takes its userfaultfd.
+ * @param loader the lazy loader.
+ *
+ * Returns the userfaultfd or -1, errno is EBADF if the trampoline has none.
+ **/
+static int take_userfaultfd(struct lazy_loader *loader)
+{
+    char byte = 0;
+    while (read(loader->ready_fd, &byte, 1) == -1 && errno == EINTR);
+
+    int uffd = syscall(SYS_pidfd_getfd, loader->pidfd, PARAM_UFFD_FD, 0);
+    if (uffd != -1 && write(loader->ack_fd, &byte, 1) != 1) {
+        close(uffd);
+        uffd = -1;
+    }
+    return uffd;
+}
+
+/* serve_faults
+ * @brief thread function of a lazy loader.
+ * @param data the lazy loader.
+ *
+ * @details Runs until the tracee exits. When the loader is stopped before,
+ * the remaining pages are filled, such that the tracee never depends on a
+ * userfaultfd nobody reads.
+ **/
+static void *serve_faults(void *data)
+{
+    struct lazy_loader *loader = data;
+    int uffd = take_userfaultfd(loader);
+    if (uffd == -1 && errno == EBADF) {
+        // the trampoline had no userfaultfd and loaded the image eagerly.
+        fprintf(logfile, "lazy loading: pid %d loaded its image without userfaultfd\n", loader->pid);
+        return NULL;
+    }
+    if (uffd == -1) {
+        fprintf(logfile, "Error: lazy loading of pid %d failed! %s\n", loader->pid, strerror(errno));
+        kill(loader->pid, SIGKILL);
+        return NULL;
+    }
+
+    struct pollfd fds[3] = {
+        { .fd = loader->pidfd, .events = POLLIN },
+        { .fd = loader->stop[0], .events = POLLIN },
+        { .fd = uffd, .events = POLLIN }
+    };
+    while (true) {
+        if (poll(fds, 3, -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (fds[0].revents != 0) {
+            break;
+        }
+        if (fds[1].revents != 0) {
+            fill_all(loader, uffd);
+            break;
+        }
+        if (fds[2].revents & (POLLERR | POLLHUP)) {
+            break;
+        }
+
+        struct uffd_msg message;
+        if (read(uffd, &message, sizeof(message)) != sizeof(message)) {
+            continue;
+        }
+        if (message.event == UFFD_EVENT_PAGEFAULT) {
+            unsigned int address = message.arg.pagefault.address & ~(PAGE_SIZE - 1);
+            if (fill_page(loader, uffd, address)) {
+                loader->faults++;
+            }
+        } else if (message.event == UFFD_EVENT_FORK) {
+            // the child gets everything, it is not worth tracking its faults.
+            int child = message.arg.fork.ufd;
+            fill_all(loader, child);
+            close(child);
+        }
+    }
+
+    close(uffd);
+    return NULL;
+}
+
+/* start_lazy_loader
+ * @brief starts serving the page faults of a launched trampoline.
+ * @param pid the PID of the a.out host process.
+ * @param header pointer to the a.out header of the image.
+ * @param image the lazy image (see lazy_image), image->fd is duplicated.
+ * @param ready_fd read end of the pipe whose write end is PARAM_READY_FD in the tracee.
+ * @param ack_fd write end of the parameter pipe.
+ *
+ * @details Takes ownership of ready_fd and ack_fd, even on error.
+ * Returns NULL on error.
+ **/
+struct lazy_loader *start_lazy_loader(pid_t pid, struct exec *header, struct image *image, int ready_fd, int ack_fd)
+{
+    struct lazy_loader *loader = calloc(1, sizeof(struct lazy_loader));
+    if (loader == NULL) {
+        close(ready_fd);
+        close(ack_fd);
+        return NULL;
+    }
+    loader->pid = pid;
+    loader->header = *header;
+    loader->image = *image;
+    loader->ready_fd = ready_fd;
+    loader->ack_fd = ack_fd;
+    loader->pidfd = syscall(SYS_pidfd_open, pid, 0);
+    loader->source = fcntl(image->fd, F_DUPFD_CLOEXEC, 0);
+    loader->stop[0] = loader->stop[1] = -1;
+
+    if (loader->pidfd != -1 && loader->source != -1 && pipe2(loader->stop, O_CLOEXEC) == 0) {
+        int error = start_thread(&loader->thread, serve_faults, loader);
+        if (error == 0) {
+            return loader;
+        }
+        errno = error;
+    }
+
+    int error = errno;
+    close(loader->pidfd);
+    close(loader->source);
+    close(loader->stop[0]);
+    close(loader->stop[1]);
+    close(ready_fd);
+    close(ack_fd);
+    free(loader);
+    errno = error;
+    return NULL;
+}
+
+/* finish_lazy_loader
+ * @brief stops a lazy loader and releases it.
+ * @param loader the lazy loader.
+ * @param pages set to the number of pages of the image.
+ *
+ * @details If the tracee is still running, all pages are filled first.
+ * Returns the number of pages that were filled on first access.
+ **/
+unsigned long finish_lazy_loader(struct lazy_loader *loader, unsigned int *pages)
+{
+    close(loader->stop[1]);
+    pthread_join(loader->thread, NULL);
+
+    unsigned long faults = loader->faults;
+    *pages = loader->image.length / PAGE_SIZE;
+    close(loader->stop[0]);
+    close(loader->pidfd);
+    close(loader->source);
+    close(loader->ready_fd);
+    close(loader->ack_fd);
+    free(loader);
+    return faults;
+}
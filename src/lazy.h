@@ -0,0 +1,24 @@
+/**
+ * @file lazy.h
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief userfaultfd based lazy loading of non-QMAGIC images.
+ */
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+#include "a.out.h"
+#include "image.h"
+
+#ifndef LAZY_H
+#define LAZY_H
+
+struct lazy_loader;
+
+bool lazy_loading_available();
+struct lazy_loader *start_lazy_loader(pid_t pid, struct exec *header, struct image *image, int ready_fd, int ack_fd);
+unsigned long finish_lazy_loader(struct lazy_loader *loader, unsigned int *pages);
+
+#endif
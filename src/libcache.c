@@ -0,0 +1,179 @@
+/**
+ * @file libcache.c
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief cache of the libraries looked up by perform_uselib.
+ *
+ * @details ld.so probes several paths for every library, thus the same
+ * lookups, most of them failing, are repeated by every process. An entry
+ * keeps the library open together with the parameters of _syscall_mmap_lib,
+ * or the error of a failed lookup. Only successful lookups and lookups
+ * failing with ENOENT are served from the cache. It is keyed by the requested path and
+ * stays valid as long as the file it was found in has the same device,
+ * inode and modification time, or still does not exist. Checking an entry
+ * costs a single stat call.
+ */
+
+#undef __x86_64__ // undefine x86_64 env to make vscode
+				  // use 32-bit header files
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <linux/limits.h>
+
+#include "libcache.h"
+
+/* hash
+ * @brief djb2 hash of a path, see uselib.c.
+ **/
+static unsigned long hash(const char *path)
+{
+    unsigned long hash = 5381;
+    int c;
+    while ((c = *path++))
+        hash = ((hash << 5) + hash) + c;
+    return hash % LIBRARY_BUCKETS;
+}
+
+/* stat_source
+ * @brief stats a file or, for "archive(member)", the archive.
+ * @param source the path.
+ * @param st the result.
+ **/
+static int stat_source(const char *source, struct stat *st)
+{
+    if (stat(source, st) == 0) {
+        return 0;
+    }
+    const char *open_paren = strrchr(source, '(');
+    size_t length = strlen(source);
+    if (errno != ENOENT || open_paren == NULL || open_paren == source || source[length - 1] != ')') {
+        return -1;
+    }
+    char archive[PATH_MAX];
+    snprintf(archive, sizeof(archive), "%.*s", (int)(open_paren - source), source);
+    return stat(archive, st);
+}
+
+/* is_current
+ * @brief returns true if the source of an entry did not change.
+ * @param library the entry.
+ **/
+static bool is_current(struct library *library)
+{
+    struct stat st;
+    bool exists = stat_source(library->source, &st) == 0;
+    if (!library->exists || !exists) {
+        return library->exists == exists;
+    }
+    return st.st_dev == library->dev && st.st_ino == library->ino
+        && st.st_mtim.tv_sec == library->mtime.tv_sec && st.st_mtim.tv_nsec == library->mtime.tv_nsec;
+}
+
+/* free_library
+ * @brief closes and releases an entry.
+ **/
+static void free_library(struct library *library)
+{
+    if (library->fd != -1) {
+        close(library->fd);
+    }
+    if (library->copy != -1) {
+        close(library->copy);
+    }
+    free(library->request);
+    free(library->path);
+    free(library->source);
+    free(library);
+}
+
+/* find_library
+ * @brief returns the cached result of a lookup or NULL.
+ * @param cache the library cache.
+ * @param request the path passed to uselib.
+ *
+ * @details An entry whose source changed is removed. So is a failed lookup
+ * with an error other than ENOENT (e.g. EACCES, ENOMEM), which may be
+ * transient and is retried instead of being served from the cache.
+ **/
+struct library *find_library(struct library_cache *cache, const char *request)
+{
+    struct library **link = &cache->buckets[hash(request)];
+    while (*link != NULL) {
+        struct library *library = *link;
+        if (strcmp(library->request, request) == 0) {
+            if ((library->error == 0 || library->error == -ENOENT) && is_current(library)) {
+                cache->hits++;
+                return library;
+            }
+            *link = library->next;
+            free_library(library);
+            break;
+        }
+        link = &library->next;
+    }
+    cache->misses++;
+    return NULL;
+}
+
+/* add_library
+ * @brief adds an entry for a lookup, the caller fills in the result.
+ * @param cache the library cache.
+ * @param request the path passed to uselib.
+ * @param source the file (or "archive(member)") the library is looked up in.
+ *
+ * @details The identity of source is recorded right away, i.e. right after
+ * the lookup. The entry is a failed lookup (ENOENT) until the caller
+ * changes it. Returns NULL if out of memory.
+ **/
+struct library *add_library(struct library_cache *cache, const char *request, const char *source)
+{
+    struct library *library = calloc(1, sizeof(struct library));
+    if (library == NULL) {
+        return NULL;
+    }
+    library->request = strdup(request);
+    library->source = strdup(source);
+    library->fd = -1;
+    library->copy = -1;
+    library->error = -ENOENT;
+    if (library->request == NULL || library->source == NULL) {
+        free_library(library);
+        return NULL;
+    }
+
+    struct stat st;
+    library->exists = stat_source(source, &st) == 0;
+    if (library->exists) {
+        library->dev = st.st_dev;
+        library->ino = st.st_ino;
+        library->mtime = st.st_mtim;
+    }
+
+    unsigned long bucket = hash(request);
+    library->next = cache->buckets[bucket];
+    cache->buckets[bucket] = library;
+    return library;
+}
+
+/* free_library_cache
+ * @brief closes all libraries and removes all entries.
+ * @param cache the library cache.
+ **/
+void free_library_cache(struct library_cache *cache)
+{
+    for (int i = 0; i < LIBRARY_BUCKETS; i++) {
+        struct library *library = cache->buckets[i];
+        while (library != NULL) {
+            struct library *next = library->next;
+            free_library(library);
+            library = next;
+        }
+    }
+    memset(cache, 0, sizeof(struct library_cache));
+}
@@ -0,0 +1,49 @@
+/**
+ * @file libcache.h
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief cache of the libraries looked up by perform_uselib.
+ */
+
+#include <stdbool.h>
+#include <time.h>
+#include <sys/types.h>
+
+#ifndef LIBCACHE_H
+#define LIBCACHE_H
+
+#define LIBRARY_BUCKETS 64
+
+// the result of a uselib lookup, successful or not.
+struct library {
+    char *request;           /* path passed to uselib */
+    int error;               /* negative error number of a failed lookup, 0 on success */
+    char *path;              /* path opened by the tracee */
+    int fd;                  /* keeps the file, archive or copy open, -1 if failed */
+    int copy;                /* copy of a member that is not page aligned or -1 */
+    unsigned int offset;     /* page aligned offset of the library in path */
+    unsigned int start;      /* parameters of _syscall_mmap_lib */
+    unsigned int length;
+    unsigned int text_length;
+    unsigned int bss_start;
+    unsigned int bss_length;
+    char *source;            /* the file (or archive) the library was looked up in */
+    bool exists;             /* source existed when the library was looked up */
+    dev_t dev;               /* identity of source, see find_library */
+    ino_t ino;
+    struct timespec mtime;
+    struct library *next;
+};
+
+struct library_cache {
+    struct library *buckets[LIBRARY_BUCKETS];
+    unsigned long hits;
+    unsigned long misses;
+};
+
+struct library *find_library(struct library_cache *cache, const char *request);
+struct library *add_library(struct library_cache *cache, const char *request, const char *source);
+void free_library_cache(struct library_cache *cache);
+
+#endif
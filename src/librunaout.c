@@ -0,0 +1,2011 @@
+/**
+ * @file librunaout.c
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief loader and controller of run-aout, see librunaout.h.
+ */
+
+#define _GNU_SOURCE
+
+#undef __x86_64__ // undefine x86_64 env to make vscode
+				  // use 32-bit header files
+
+// c stdlib headers
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include <stddef.h>
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+
+// UNIX system headers
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/ptrace.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/user.h>
+#include <sys/types.h>
+#include <sys/reg.h>
+#include <sys/syscall.h>
+#include <linux/limits.h>
+#include <signal.h>
+#include <syscall.h>
+
+// custom headers
+#include "a.out.h"
+#include "uselib.h"
+#include "run-aout.h"
+#include "helpers.h"
+#include "debug.h"
+#include "seccomp.h"
+#include "params.h"
+#include "tracees.h"
+#include "affinity.h"
+#include "image.h"
+#include "cache.h"
+#include "lazy.h"
+#include "archive.h"
+#include "libcache.h"
+#include "object.h"
+#include "librunaout.h"
+#include "trampoline.h"
+
+// kernel internal error codes of interrupted system calls, see is_interrupted_syscall.
+#define ERESTARTSYS 512
+#define ERESTART_RESTARTBLOCK 516
+
+// how prepare_aout handles non-QMAGIC images.
+enum preparation {
+    PREPARE_NOW,       /* convert the image before the trampoline is started */
+    PREPARE_LAZY,      /* fill the pages on first access, see lazy.c */
+    PREPARE_PIPELINED  /* convert the image while the trampoline starts, see start_conversion */
+};
+
+// diagnostic output of the helpers, set to the log of the context by every API call.
+FILE *logfile = NULL;
+
+// a program started by runaout_launch and all processes it created.
+struct job {
+    pid_t pid;
+    int tracees;   /* number of processes still traced */
+    bool exited;
+    int exit_code;
+    struct placement placement;
+    struct lazy_loader *loader; /* NULL unless the image is loaded lazily */
+    struct conversion *conversion; /* NULL unless the image is converted in the background */
+};
+
+struct runaout_context {
+    struct runaout_options options;
+    char trampoline[PATH_MAX]; /* absolute path, used to redirect execve */
+    FILE *log;
+    bool owns_log;
+    struct uselib_table uselib;
+    struct trampoline_params params; /* template, see build_params_template */
+    pthread_t preload;   /* reads uselib.conf, see wait_preload */
+    pthread_mutex_t preload_lock;
+    bool preloading;     /* preload has not been joined yet */
+    struct tracee_table tracees;
+    struct job *jobs;
+    int njobs;
+    int jobs_capacity;
+    struct image_cache cache;
+    struct library_cache libraries; /* see lookup_library */
+    bool lazy; /* lazy_load was requested and userfaultfd is available */
+    struct runaout_stats stats;
+};
+
+/* find_job
+ * @brief returns the job with the given PID or NULL if not found.
+ * @param context the run-aout instance.
+ * @param pid the PID returned by runaout_launch.
+ **/
+static struct job *find_job(runaout_t context, pid_t pid)
+{
+    for (int i = 0; i < context->njobs; i++) {
+        if (context->jobs[i].pid == pid) {
+            return &context->jobs[i];
+        }
+    }
+    return NULL;
+}
+
+/* add_job
+ * @brief adds a new job, pointers returned by find_job are invalidated.
+ * @param context the run-aout instance.
+ * @param pid the PID of the launched process.
+ **/
+static struct job *add_job(runaout_t context, pid_t pid)
+{
+    if (context->njobs == context->jobs_capacity) {
+        int capacity = context->jobs_capacity > 0 ? context->jobs_capacity * 2 : 16;
+        struct job *jobs = realloc(context->jobs, capacity * sizeof(struct job));
+        if (jobs == NULL) {
+            return NULL;
+        }
+        context->jobs = jobs;
+        context->jobs_capacity = capacity;
+    }
+    struct job *job = &context->jobs[context->njobs++];
+    memset(job, 0, sizeof(struct job));
+    job->pid = pid;
+    job->exit_code = EXIT_FAILURE;
+    job->placement.controller_cpu = -1;
+    job->placement.tracee_cpu = -1;
+    return job;
+}
+
+/* remove_job
+ * @brief removes a job once its exit code was returned by runaout_wait.
+ * @param context the run-aout instance.
+ * @param pid the PID of the launched process.
+ **/
+static void remove_job(runaout_t context, pid_t pid)
+{
+    struct job *job = find_job(context, pid);
+    if (job != NULL) {
+        *job = context->jobs[--context->njobs];
+    }
+}
+
+/* forget_tracee
+ * @brief removes a tracee, which exited or was detached.
+ * @param context the run-aout instance.
+ * @param pid the PID of the tracee.
+ **/
+static void forget_tracee(runaout_t context, pid_t pid)
+{
+    traceep tracee = get_tracee(&context->tracees, pid);
+    if (tracee == NULL) {
+        return;
+    }
+    struct job *job = find_job(context, tracee->job);
+    if (job != NULL) {
+        job->tracees--;
+    }
+    remove_tracee(&context->tracees, pid);
+}
+
+/* resume_request
+ * @brief returns the ptrace request used to resume tracees.
+ * @param context the run-aout instance.
+ **/
+static int resume_request(runaout_t context)
+{
+    return context->options.use_seccomp ? PTRACE_CONT : PTRACE_SYSCALL;
+}
+
+/* report_prefaulted
+ * @brief counts the pages the startup modes made resident in an address range.
+ * @param context the run-aout instance.
+ * @param pid the PID of the a.out host process.
+ * @param start start of the range.
+ * @param end end of the range (exclusive).
+ * @param what the name of the image, for the log.
+ *
+ * @details Every resident page is a page fault the a.out program does not take
+ * on its first access, because nothing touched the range since it was mapped.
+ **/
+static void report_prefaulted(runaout_t context, pid_t pid, unsigned long start, unsigned long end, const char *what)
+{
+    unsigned long pages = resident_pages(pid, start, end);
+    context->stats.prefaulted += pages;
+    fprintf(logfile, "startup: %lu page faults removed for %s of pid %d\n", pages, what, pid);
+}
+
+/* read_header
+ * @brief reads the a.out header of a file or archive member.
+ * @param member the file or archive member.
+ * @param header the header to fill.
+ *
+ * @details Returns false if the member is too small for an a.out header.
+ **/
+static bool read_header(struct member *member, struct exec *header)
+{
+    struct aout_object object;
+    if (!open_object(member->fd, member->offset, member->size, &object)) {
+        return false;
+    }
+    *header = *object.header;
+    close_object(&object);
+    return true;
+}
+
+/* build_params_template
+ * @brief fills the parts of the parameter block shared by all launches.
+ * @param context the run-aout instance.
+ *
+ * @details The seccomp filter and the uselib.conf mappings are always included,
+ * such that the in-process uselib handler can be installed later on
+ * (see detach_tracee).
+ **/
+static void build_params_template(runaout_t context)
+{
+    struct trampoline_params *params = &context->params;
+    memset(params, 0, sizeof(struct trampoline_params));
+
+    // let the trampoline emulate uselib on its own.
+    if (context->options.in_process) {
+        params->flags |= PARAM_FLAG_INPROCESS;
+    }
+    // the detach breakpoint can only be set and the prefaulted pages
+    // can only be counted once the image is mapped.
+    if (!context->options.in_process
+        && (context->options.detach_trigger == DETACH_ADDRESS || context->options.startup != 0)) {
+        params->flags |= PARAM_FLAG_ENTRY_TRAP;
+    }
+    if (context->options.startup & STARTUP_PREFAULT) {
+        params->flags |= PARAM_FLAG_PREFAULT;
+    }
+    if (context->options.startup & STARTUP_HUGEPAGE) {
+        params->flags |= PARAM_FLAG_HUGEPAGE;
+    }
+    if (context->options.startup & STARTUP_MLOCK) {
+        params->flags |= PARAM_FLAG_MLOCK;
+    }
+
+    assert(sizeof(params->filter) >= USELIB_FILTER_MAX * sizeof(struct sock_filter));
+    params->filter_len = build_uselib_filter(params->filter, SECCOMP_RET_TRAP, false);
+    int dropped = serialize_entries(&context->uselib, params->libraries, sizeof(params->libraries));
+    if (dropped > 0 && context->options.in_process) {
+        fprintf(stderr, "Warning: %d uselib mappings do not fit into %d bytes, in-process mode ignores them.\n",
+            dropped, PARAM_LIBRARIES_SIZE);
+    }
+}
+
+/* open_file
+ * @brief opens a program or library, which may be a member of the bundle.
+ * @param context the run-aout instance.
+ * @param name the path of a file or "archive(member)".
+ * @param member the file or member to fill.
+ * @param opened set to the name that was opened, NULL or a buffer of PATH_MAX bytes.
+ *
+ * @details If a bundle is used, the base name of a file is looked up
+ * in the bundle first, such that the absolute paths of uselib.conf
+ * and of the uselib calls need not be changed.
+ **/
+static bool open_file(runaout_t context, const char *name, struct member *member, char *opened)
+{
+    char path[PATH_MAX];
+    if (context->options.bundle != NULL && strchr(name, '(') == NULL) {
+        const char *base = strrchr(name, '/');
+        snprintf(path, sizeof(path), "%s(%s)", context->options.bundle, base != NULL ? base + 1 : name);
+        if (open_member(path, O_RDONLY | O_CLOEXEC, member)) {
+            if (opened != NULL) {
+                snprintf(opened, PATH_MAX, "%s", path);
+            }
+            return true;
+        }
+    }
+    if (opened != NULL) {
+        snprintf(opened, PATH_MAX, "%s", name);
+    }
+    return open_member(name, O_RDONLY | O_CLOEXEC, member);
+}
+
+/* read_bundled_uselibconf
+ * @brief reads uselib.conf out of the bundle.
+ * @param context the run-aout instance.
+ *
+ * @details Returns false if the bundle contains no uselib.conf.
+ **/
+static bool read_bundled_uselibconf(runaout_t context)
+{
+    char path[PATH_MAX];
+    struct member member;
+    snprintf(path, sizeof(path), "%s(uselib.conf)", context->options.bundle);
+    if (!open_member(path, O_RDONLY | O_CLOEXEC, &member)) {
+        return false;
+    }
+    char *buffer = malloc(member.size > 0 ? member.size : 1);
+    bool success = buffer != NULL && pread(member.fd, buffer, member.size, member.offset) == member.size;
+    close(member.fd);
+    FILE *uselib = success ? fmemopen(buffer, member.size, "r") : NULL;
+    if (uselib != NULL) {
+        read_uselib_entries(&context->uselib, uselib, path);
+        fclose(uselib);
+    }
+    free(buffer);
+    return uselib != NULL;
+}
+
+/* prefetch_library
+ * @brief for_each_entry callback of preload, reads a library into the page cache.
+ * @details Compressed bundle members are decompressed.
+ **/
+static void prefetch_library(entryp entry, void *data)
+{
+    struct member member;
+    if (open_file(data, entry->value, &member, NULL)) {
+        posix_fadvise(member.fd, member.offset, member.size, POSIX_FADV_WILLNEED);
+        close(member.fd);
+    }
+}
+
+/* is_older
+ * @brief returns true if both files exist and the first one was modified before the second one.
+ * @param path the first file.
+ * @param other the second file.
+ **/
+static bool is_older(const char *path, const char *other)
+{
+    struct stat st, other_st;
+    if (stat(path, &st) != 0 || stat(other, &other_st) != 0) {
+        return false;
+    }
+    return st.st_mtim.tv_sec < other_st.st_mtim.tv_sec
+        || (st.st_mtim.tv_sec == other_st.st_mtim.tv_sec && st.st_mtim.tv_nsec < other_st.st_mtim.tv_nsec);
+}
+
+/* preload
+ * @brief thread function started by runaout_create.
+ * @param data the run-aout instance.
+ *
+ * @details Reads uselib.conf, builds the parameter template and starts
+ * reading the mapped libraries, while the first image is prepared.
+ * A bundle is read as a whole, it is laid out for one sequential read.
+ * Nothing else touches the uselib table and the template until
+ * wait_preload returns.
+ **/
+static void *preload(void *data)
+{
+    runaout_t context = data;
+    if (context->options.bundle != NULL) {
+        int fd = open(context->options.bundle, O_RDONLY | O_CLOEXEC);
+        if (fd != -1) {
+            posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+            posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+            close(fd);
+        }
+    }
+
+    // an explicit uselib.conf, the one of the bundle, the compiled index or uselib.conf.
+    const char *uselib_conf = context->options.uselib_conf;
+    const char *uselib_index = context->options.uselib_index;
+    if (uselib_conf != NULL) {
+        read_uselibconf(&context->uselib, uselib_conf);
+    } else if (context->options.bundle == NULL || !read_bundled_uselibconf(context)) {
+        const char *index = uselib_index != NULL ? uselib_index : "uselib.idx";
+        bool stale = is_older(index, "uselib.conf");
+        if (stale) {
+            fprintf(stderr, "Warning: library index '%s' is older than uselib.conf, reading uselib.conf.\n", index);
+        }
+        if (stale || !open_uselib_index(&context->uselib, index)) {
+            if (uselib_index != NULL && !stale) {
+                fprintf(stderr, "Warning: cannot open library index '%s', reading uselib.conf.\n", uselib_index);
+            }
+            read_uselibconf(&context->uselib, "uselib.conf");
+        }
+    }
+    build_params_template(context);
+    for_each_entry(&context->uselib, prefetch_library, context);
+    return NULL;
+}
+
+/* wait_preload
+ * @brief waits until uselib.conf is read, see preload.
+ * @param context the run-aout instance.
+ *
+ * @details May be called by any thread, also by conversion threads.
+ **/
+static void wait_preload(runaout_t context)
+{
+    pthread_mutex_lock(&context->preload_lock);
+    if (context->preloading) {
+        pthread_join(context->preload, NULL);
+        context->preloading = false;
+    }
+    pthread_mutex_unlock(&context->preload_lock);
+}
+
+/* convert_aout
+ * @brief converts a non-QMAGIC image, using the image cache if enabled.
+ * @param context the run-aout instance.
+ * @param fd file descriptor of the a.out executable or library.
+ * @param header pointer to the a.out header of the image.
+ * @param text_offset offset of the text section in the image.
+ * @param data_offset offset of the data section in the image (see prepare_image).
+ * @param image the image to fill.
+ * @param preparation how the image is converted.
+ *
+ * @details Cached images are never pipelined, a hit needs no conversion and
+ * a miss is stored while converting.
+ **/
+static bool convert_aout(runaout_t context, int fd, struct exec *header,
+    unsigned int text_offset, unsigned int data_offset, struct image *image, enum preparation preparation)
+{
+    if (preparation == PREPARE_LAZY) {
+        lazy_image(fd, header, text_offset, data_offset, image);
+        return true;
+    }
+    if (cached_image(&context->cache, fd, header, text_offset, data_offset, image)) {
+        return true;
+    }
+    if (preparation == PREPARE_PIPELINED && context->cache.dir == -1) {
+        return pending_image(header, text_offset, data_offset, image);
+    }
+    return prepare_image(fd, header, text_offset, data_offset, image);
+}
+
+/* library_file
+ * @brief returns the file uselib opens for a request, i.e. the uselib.conf
+ * mapping of its base name or the request itself (see _sigsys_handler).
+ * @param context the run-aout instance.
+ * @param request the path passed to uselib.
+ **/
+static char *library_file(runaout_t context, char *request)
+{
+    char *mapping = get_entry(&context->uselib, strlast(request, "/"));
+    return mapping != NULL ? mapping : request;
+}
+
+/* lookup_library
+ * @brief looks up a library for uselib, see perform_uselib.
+ * @param context the run-aout instance.
+ * @param request the path passed to uselib.
+ *
+ * @details Searches uselib.conf for a mapping, opens the library (which may
+ * be an archive or bundle member) and validates its header. ZMAGIC and
+ * OMAGIC libraries are converted (see convert_aout). The result,
+ * including a failed lookup, is kept in the library cache, the library
+ * stays open. Returns NULL if out of memory.
+ **/
+static struct library *lookup_library(runaout_t context, char *request)
+{
+    struct library *library = find_library(&context->libraries, request);
+    if (library != NULL) {
+        fprintf(logfile, "'%s' cached: %s\n", request, library->error == 0 ? library->path : strerror(-library->error));
+        return library;
+    }
+
+    // search uselib.conf for a library mapping.
+    char *file = library_file(context, request);
+    fprintf(logfile, "'%s' mapped as '%s'\n", request, file);
+
+    // open the a.out library file, which may be an archive member.
+    struct member member;
+    char opened[PATH_MAX];
+    bool found = open_file(context, file, &member, opened);
+    int error = errno;
+    library = add_library(&context->libraries, request, found ? opened : file);
+    if (library == NULL) {
+        if (found) {
+            close(member.fd);
+        }
+        return NULL;
+    }
+    if (!found) {
+        fprintf(logfile, "Error open: '%s' not found or not accessible!\n", file);
+        library->error = error == ENOENT || error == ENOTDIR ? -ENOENT : -error;
+        return library;
+    }
+    library->fd = member.fd;
+    library->error = -ENOEXEC;
+
+    // read and validate the a.out header.
+    struct exec header;
+    if (!read_header(&member, &header)) {
+        return library;
+    }
+
+    print_aout_header(&header);
+
+    if (!validate_header(&header)) {
+        return library;
+    }
+    struct image image;
+    switch (N_MAGIC(header)) {
+    case MAGIC_QMAGIC:
+        // the tracee maps the file or archive, if the library is page
+        // aligned in it, otherwise a copy.
+        if (member.offset % 0x1000 == 0) {
+            qmagic_image(member.fd, &header, &image);
+            image.offset = member.offset;
+            break;
+        }
+        library->copy = extract_image(member.fd, member.offset, member.size);
+        if (library->copy == -1) {
+            return library;
+        }
+        qmagic_image(library->copy, &header, &image);
+        break;
+    case MAGIC_ZMAGIC:
+    case MAGIC_OMAGIC:
+        // converted once like an executable (see prepare_aout), the image
+        // cache shares the result between launches. The base is still
+        // given by a_entry, see describe_image.
+        if (!convert_aout(context, member.fd, &header, member.offset + N_TXTOFF(header), 0, &image, PREPARE_NOW)) {
+            return library;
+        }
+        library->copy = image.fd;
+        break;
+    default:
+        fprintf(logfile, "ERR: library not QMAGIC, ZMAGIC or OMAGIC, abort!\n");
+        return library;
+    }
+
+    // copies and converted images are opened by the tracee through /proc.
+    if (image.fd != member.fd) {
+        snprintf(member.path, sizeof(member.path), "/proc/%d/fd/%d", getpid(), image.fd);
+    }
+    library->path = strdup(member.path);
+    if (library->path == NULL) {
+        library->error = -ENOMEM;
+        return library;
+    }
+
+    library->offset = image.offset;
+    library->start = image.start;
+    library->length = image.length;
+    library->text_length = image.text_length;
+    library->bss_start = image.bss_start;
+    library->bss_length = image.bss_length;
+    library->error = 0;
+    return library;
+}
+
+/* is_premapped
+ * @brief returns true if _start mapped a library in a tracee, see scan_libraries.
+ * @param context the run-aout instance.
+ * @param tracee the a.out host process.
+ * @param request the path passed to uselib.
+ * @param library the library found for the request.
+ *
+ * @details The premap table is read from the parameter block of the
+ * tracee, such that it always matches the image the tracee runs, even
+ * after fork or execve. Entries are matched by the file the request
+ * resolves to (see library_file), like _is_premapped does in-process,
+ * because converted libraries are opened through a path of the controller.
+ **/
+static bool is_premapped(runaout_t context, traceep tracee, char *request, struct library *library)
+{
+    struct premap_table premap;
+    unsigned long address = SYM_PARAMS + offsetof(struct trampoline_params, premap);
+    if (!tracee->aout_host
+        || read_memory(tracee->pid, address, &premap, sizeof(premap)) != sizeof(premap)) {
+        return false;
+    }
+    char *file = library_file(context, request);
+    for (unsigned int i = 0; i < premap.count && i < PARAM_PREMAP_MAX; i++) {
+        struct premapped_library *entry = &premap.libraries[i];
+        if (entry->start == library->start
+            && entry->name < PARAM_PREMAP_PATHS_SIZE
+            && strncmp(premap.paths + entry->name, file, PARAM_PREMAP_PATHS_SIZE - entry->name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* perform_uselib
+ * @brief emulates the uselib syscall.
+ * @param context the run-aout instance.
+ * @param tracee the a.out host process.
+ *
+ * @details Emulates the behavior of the uselib system call as expected by a.out.
+ * The filename of the library to be loaded is stored in the EBX register.
+ * Opens the a.out library file and checks whether it is uses the correct
+ * format and is executable. After determining the parameters a_entry,
+ * a_text, a_data and a_bss forwards them to the a.out host process
+ * and "calls" _syscall_mmap_lib * by setting EIP to the beginning
+ * of the trampoline module. After _syscall_mmap_lib is finished,
+ * resumes normal execution of the a.out program. Libraries mapped at
+ * startup (see is_premapped) succeed without running the tracee.
+ **/
+static int perform_uselib(runaout_t context, traceep tracee)
+{
+    pid_t pid = tracee->pid;
+
+    // get registers
+    struct user_regs_struct regs;
+    ptrace(PTRACE_GETREGS, pid, NULL, &regs);
+
+    // get the filename of the a.out library file from the a.out host.
+    long filename = regs.ebx;
+    char buffer[PATH_MAX];
+    if (read_string(pid, filename, buffer, sizeof(buffer)) < 0) {
+        fprintf(logfile, "Error: cannot read uselib filename at 0x%08lx!\n", filename);
+        return -EFAULT;
+    }
+
+    fprintf(logfile, "\ntrying to perform uselib for: %s\n", buffer);
+
+    wait_preload(context);
+    struct library *library = lookup_library(context, buffer);
+    if (library == NULL) {
+        return -ENOMEM;
+    }
+    if (library->error != 0) {
+        return library->error;
+    }
+    if (is_premapped(context, tracee, buffer, library)) {
+        fprintf(logfile, "'%s' already mapped at startup\n", buffer);
+        return 0;
+    }
+
+    // the tracee opens and maps the library itself.
+    if (strcmp(library->path, buffer) != 0) {
+        filename = set_data(pid, library->path, strlen(library->path) + 1);
+        print_data(pid, filename, 1024);
+    }
+
+    // jump to _syscall_mmap_lib in trampoline image and patch the
+    // immediate operands of its mov instructions (opcode is 1 byte).
+    regs.eip = SYM_SYSCALL_MMAP_LIB;
+    ptrace(PTRACE_SETREGS, pid, NULL, &regs);
+    ptrace(PTRACE_POKETEXT, pid, SYM_SYSCALL_MMAP_LIB_FILENAME + 1, filename);
+    ptrace(PTRACE_POKETEXT, pid, SYM_SYSCALL_MMAP_LIB_START + 1, library->start);
+    ptrace(PTRACE_POKETEXT, pid, SYM_SYSCALL_MMAP_LIB_LENGTH + 1, library->length);
+    ptrace(PTRACE_POKETEXT, pid, SYM_SYSCALL_MMAP_LIB_TEXT_LENGTH + 1, library->text_length);
+    ptrace(PTRACE_POKETEXT, pid, SYM_SYSCALL_MMAP_LIB_OFFSET + 1, library->offset);
+    ptrace(PTRACE_POKETEXT, pid, SYM_SYSCALL_MMAP_LIB_BSS_START + 1, library->bss_start);
+    ptrace(PTRACE_POKETEXT, pid, SYM_SYSCALL_MMAP_LIB_BSS_LENGTH + 1, library->bss_length);
+
+    // run _syscall_mmap_lib until it returns, then read the result value from EAX.
+    int status = run_to_address(pid, SYM_SYSCALL_MMAP_LIB_RETURN);
+    if (WIFSTOPPED(status)) {
+        ptrace(PTRACE_GETREGS, pid, NULL, &regs);
+        if ((int)regs.eax == 0 && context->options.startup != 0) {
+            unsigned long end = library->start + library->length + library->bss_length;
+            report_prefaulted(context, pid, library->start, end, library->request);
+        }
+        return (int)regs.eax;
+    }
+    return -ENOEXEC;
+}
+
+/* is_library_name
+ * @brief returns true if a string looks like the path of an a.out library,
+ * i.e. its last component is "ld.so" or "lib*.so.N".
+ * @param name the string.
+ **/
+static bool is_library_name(const char *name)
+{
+    const char *base = strlast((char *)name, "/");
+    if (strcmp(base, "ld.so") == 0) {
+        return true;
+    }
+    const char *suffix = strstr(base, ".so.");
+    return strncmp(base, "lib", 3) == 0 && suffix != NULL && isdigit((unsigned char)suffix[4]);
+}
+
+/* add_premapped
+ * @brief resolves a library name and adds it to a premap table.
+ * @param context the run-aout instance.
+ * @param name the library name found in the executable.
+ * @param image the image of the executable.
+ * @param premap the premap table.
+ *
+ * @details Libraries which cannot be loaded, are already in the table or
+ * overlap the image or another library are skipped, uselib handles them.
+ * Every entry has the path _map_premapped opens and the file name uselib
+ * requests resolve to (see is_premapped). In-process, converted libraries
+ * are only found through this table, _sigsys_handler maps QMAGIC files only.
+ **/
+static void add_premapped(runaout_t context, const char *name, struct image *image, struct premap_table *premap)
+{
+    char request[PATH_MAX];
+    snprintf(request, sizeof(request), "%s", name);
+    struct library *library = lookup_library(context, request);
+    if (premap->count == PARAM_PREMAP_MAX || library == NULL || library->error != 0) {
+        return;
+    }
+
+    unsigned int end = library->bss_start + library->bss_length;
+    unsigned int image_end = image->bss_start + image->bss_length;
+    if (library->start < image_end && image->start < end) {
+        return;
+    }
+    unsigned int used = 0;
+    for (unsigned int i = 0; i < premap->count; i++) {
+        struct premapped_library *entry = &premap->libraries[i];
+        if (library->start < entry->bss_start + entry->bss_length && entry->start < end) {
+            return;
+        }
+        used = entry->name + strlen(premap->paths + entry->name) + 1;
+    }
+    char *file = library_file(context, request);
+    size_t length = strlen(library->path) + 1;
+    size_t file_length = strlen(file) + 1;
+    if (used + length + file_length > PARAM_PREMAP_PATHS_SIZE) {
+        return;
+    }
+
+    fprintf(logfile, "premapping '%s' as '%s'\n", file, library->path);
+    memcpy(premap->paths + used, library->path, length);
+    memcpy(premap->paths + used + length, file, file_length);
+    premap->libraries[premap->count++] = (struct premapped_library) {
+        .path = used,
+        .name = used + length,
+        .start = library->start,
+        .length = library->length,
+        .text_length = library->text_length,
+        .offset = library->offset,
+        .bss_start = library->bss_start,
+        .bss_length = library->bss_length
+    };
+}
+
+/* scan_section
+ * @brief collects the library names in a section, see scan_libraries.
+ * @param context the run-aout instance.
+ * @param section the text or data section.
+ * @param size the size of the section.
+ * @param image the image of the executable.
+ * @param names the base names of the libraries found so far.
+ * @param premap the premap table or NULL.
+ *
+ * Returns the number of base names, which were not found before.
+ **/
+static unsigned int scan_section(runaout_t context, const char *section, size_t size, struct image *image,
+    struct uselib_table *names, struct premap_table *premap)
+{
+    unsigned int count = 0;
+    size_t start = 0;
+    for (size_t i = 0; i < size; i++) {
+        if (section[i] != '\0') {
+            if (!isgraph((unsigned char)section[i])) {
+                start = i + 1;
+            }
+            continue;
+        }
+        char *name = (char *)section + start;
+        if (i - start >= strlen("ld.so") && i - start < PATH_MAX && is_library_name(name)) {
+            // crt0 names fallback paths of ld.so, only one of them is loaded.
+            char *base = strlast(name, "/");
+            if (get_entry(names, base) == NULL) {
+                add_entry(names, base, "");
+                count++;
+            }
+            if (premap != NULL) {
+                add_premapped(context, name, image, premap);
+            }
+        }
+        start = i + 1;
+    }
+    return count;
+}
+
+/* scan_libraries
+ * @brief finds the libraries an a.out executable loads, before it runs.
+ * @param context the run-aout instance.
+ * @param member the a.out executable.
+ * @param image the prepared image of the executable.
+ * @param premap receives the libraries, which _start maps in one batch, or NULL.
+ *
+ * @details The shared library table of an executable and the path of
+ * ld.so in crt0 are plain strings in text or data, thus both sections are
+ * searched for NUL terminated library names. Every name is resolved like
+ * a uselib call (see lookup_library), a false positive only costs a
+ * mapping. Returns the number of distinct base names, i.e. the uselib
+ * calls expected before the program runs. DETACH_SYSCALL waits for all
+ * of them, a false positive keeps the tracee attached.
+ **/
+static unsigned int scan_libraries(runaout_t context, struct member *member, struct image *image,
+    struct premap_table *premap)
+{
+    if (premap != NULL) {
+        memset(premap, 0, sizeof(struct premap_table));
+    }
+    struct aout_object object;
+    if (!open_object(member->fd, member->offset, member->size, &object)) {
+        return 0;
+    }
+
+    if (premap != NULL) {
+        wait_preload(context);
+    }
+    struct uselib_table names;
+    memset(&names, 0, sizeof(names));
+    unsigned int count = 0;
+    size_t size;
+    const char *section = object_text(&object, &size);
+    if (section != NULL) {
+        count += scan_section(context, section, size, image, &names, premap);
+    }
+    section = object_data(&object, &size);
+    if (section != NULL) {
+        count += scan_section(context, section, size, image, &names, premap);
+    }
+    close_object(&object);
+    free_entries(&names);
+    return count;
+}
+
+/* scan_image_libraries
+ * @brief calls scan_libraries for a prepared image, if any option needs its libraries.
+ * @param context the run-aout instance.
+ * @param member the a.out executable.
+ * @param image the prepared image or an image with fd = -1.
+ * @param premap receives the libraries to map at startup, if premap_libraries is set.
+ *
+ * Returns the number of uselib calls expected before the program runs.
+ **/
+static unsigned int scan_image_libraries(runaout_t context, struct member *member, struct image *image,
+    struct premap_table *premap)
+{
+    if (image->fd == -1) {
+        return 0;
+    }
+    if (context->options.premap_libraries) {
+        unsigned int count = scan_libraries(context, member, image, premap);
+        context->stats.premapped += premap->count;
+        return count;
+    }
+    if (context->options.detach_trigger == DETACH_SYSCALL) {
+        return scan_libraries(context, member, image, NULL);
+    }
+    return 0;
+}
+
+/* write_params
+ * @brief sends the parameter block for _start to the trampoline.
+ * @param context the run-aout instance.
+ * @param pipe_fd write end of the pipe read by the trampoline.
+ * @param target_fd file descriptor of the image in the a.out host process.
+ * @param image the prepared image.
+ * @param premap the libraries to map at startup or NULL, see scan_libraries.
+ *
+ * @details The trampoline reads the block from PARAM_FD, maps the image
+ * and jumps to the entry point without any help from the controller.
+ * Returns false if the block could not be written.
+ **/
+static bool write_params(runaout_t context, int pipe_fd, int target_fd, struct image *image,
+    const struct premap_table *premap)
+{
+    wait_preload(context);
+    struct trampoline_params params = context->params;
+
+    params.fd = target_fd;
+    params.start = image->start;
+    params.length = image->length;
+    params.text_length = image->text_length;
+    params.offset = image->offset;
+    params.bss_start = image->bss_start;
+    params.bss_length = image->bss_length;
+    params.entry = image->entry;
+    if (image->lazy) {
+        params.flags |= PARAM_FLAG_LAZY;
+        params.text_offset = image->text_offset;
+        params.text_size = image->text_size;
+        params.data_start = image->data_start;
+        params.data_size = image->data_size;
+    }
+    if (premap != NULL) {
+        params.premap = *premap;
+    }
+
+    return write(pipe_fd, &params, sizeof(params)) == sizeof(params);
+}
+
+// a pipelined conversion, see start_conversion.
+struct conversion {
+    pthread_t thread;
+    runaout_t context;
+    int source;      /* the a.out file */
+    int pipe_fd;     /* write end of the parameter pipe */
+    struct exec header;
+    struct image image;
+    struct premap_table premap;
+};
+
+/* convert
+ * @brief thread function of a pipelined conversion.
+ * @param data the conversion.
+ *
+ * @details The trampoline blocks reading PARAM_FD until the image is
+ * complete. If the conversion fails, the parameter pipe is closed without
+ * writing the block and the trampoline exits.
+ **/
+static void *convert(void *data)
+{
+    struct conversion *conversion = data;
+    if (complete_image(conversion->source, &conversion->header, &conversion->image)) {
+        write_params(conversion->context, conversion->pipe_fd, PARAM_IMAGE_FD, &conversion->image,
+            &conversion->premap);
+    }
+    close(conversion->pipe_fd);
+    close(conversion->source);
+    close(conversion->image.fd);
+    return NULL;
+}
+
+/* start_conversion
+ * @brief converts a pending image while the trampoline starts.
+ * @param context the run-aout instance.
+ * @param source file descriptor of the a.out file.
+ * @param header pointer to the a.out header of the image.
+ * @param image the pending image (see pending_image).
+ * @param pipe_fd write end of the parameter pipe.
+ * @param premap the libraries to map at startup, see scan_libraries.
+ *
+ * @details Takes ownership of source, image->fd and pipe_fd, even on error.
+ * Returns NULL on error.
+ **/
+static struct conversion *start_conversion(runaout_t context, int source, struct exec *header,
+    struct image *image, int pipe_fd, const struct premap_table *premap)
+{
+    struct conversion *conversion = calloc(1, sizeof(struct conversion));
+    if (conversion != NULL) {
+        conversion->context = context;
+        conversion->source = source;
+        conversion->pipe_fd = pipe_fd;
+        conversion->header = *header;
+        conversion->image = *image;
+        conversion->premap = *premap;
+        int error = start_thread(&conversion->thread, convert, conversion);
+        if (error == 0) {
+            return conversion;
+        }
+        free(conversion);
+        errno = error;
+    }
+
+    int error = errno;
+    close(source);
+    close(image->fd);
+    close(pipe_fd);
+    errno = error;
+    return NULL;
+}
+
+/* finish_conversion
+ * @brief waits for a pipelined conversion and releases it.
+ * @param conversion the conversion.
+ **/
+static void finish_conversion(struct conversion *conversion)
+{
+    pthread_join(conversion->thread, NULL);
+    free(conversion);
+}
+
+/* check_root_or_mmap_min_addr
+ * @brief checks whether we're root and whether mmap_min_addr is set correctly.
+ * @param expected_min_addr required minimum address for the execution of the binary.
+ *
+ * @details Returns false and prints an error, if the binary cannot be mapped.
+ **/
+static bool check_root_or_mmap_min_addr(unsigned int expected_min_addr)
+{
+    if (getuid() == 0) {
+        // user is root, we can ontinue
+        return true;
+    }
+
+    FILE *ctl_file = fopen("/proc/sys/vm/mmap_min_addr", "r");
+    unsigned int mmap_min_addr;
+    fscanf(ctl_file, "%u", &mmap_min_addr);
+    fclose(ctl_file);
+    if (mmap_min_addr > expected_min_addr) {
+        fprintf(stderr, "Cannot execute binary, because vm.mmap_min_addr = 0x%x is preventing mmap at address 0x%x.\n", mmap_min_addr, expected_min_addr);
+        return false;
+    }
+    return true;
+}
+
+/* prepare_aout
+ * @brief prepares an a.out executable for the trampoline.
+ * @param context the run-aout instance.
+ * @param member the a.out executable, a file or an archive member.
+ * @param header pointer to the previously validated a.out header.
+ * @param image the image to fill.
+ * @param preparation how non-QMAGIC images are converted.
+ *
+ * @details image->fd is member->fd itself, if the image can be mapped as is
+ * (QMAGIC at a page aligned offset), otherwise a memfd containing the prepared
+ * image (empty if image->pending is set). Returns false on error.
+ **/
+static bool prepare_aout(runaout_t context, struct member *member, struct exec *header, struct image *image,
+    enum preparation preparation)
+{
+    int fd = member->fd;
+    off_t base = member->offset;
+    switch (N_MAGIC(*header))
+    {
+    case MAGIC_QMAGIC:
+        // verify whether we can map to address 0x1000.
+        if (!check_root_or_mmap_min_addr(0x1000)) {
+            return false;
+        }
+        // no further adjustments necessary, unless the archive member
+        // is not page aligned, it cannot be mapped in place then.
+        if (base % 0x1000 == 0) {
+            qmagic_image(fd, header, image);
+            image->offset = base;
+            return true;
+        }
+        int copy = extract_image(fd, base, member->size);
+        if (copy == -1) {
+            return false;
+        }
+        qmagic_image(copy, header, image);
+        return true;
+    case MAGIC_OMAGIC:
+        // verify whether we can map to address 0x0.
+        if (!check_root_or_mmap_min_addr(0)) {
+            return false;
+        }
+        // prepare OMAGIC image: skip the a.out header and leave
+        // no gap/alignment between text and data.
+        return convert_aout(context, fd, header, base + N_TXTOFF(*header), 0, image, preparation);
+    case MAGIC_NMAGIC:
+        // verify whether we can map to address 0x0.
+        if (!check_root_or_mmap_min_addr(0)) {
+            return false;
+        }
+        // prepare NMAGIC image: skip the a.out header and leave
+        // a gap of at most 0x1000 bytes between text and data, such
+        // that the data section is aligned at a page boundary.
+        // NOTE: currently this only supports text sections <= 4KB.
+        // NOTE: this is completely untested, as I have yet to find an
+        // NMAGIC a.out binary.
+        return convert_aout(context, fd, header, base + N_TXTOFF(*header), 0x1000, image, preparation);
+    case MAGIC_ZMAGIC:
+        // verify whether we can map to address 0x0.
+        if (!check_root_or_mmap_min_addr(0)) {
+            return false;
+        }
+        // prepare ZMAGIC image: skip the a.out header and the 1KB padding
+        // before the text section.
+        return convert_aout(context, fd, header, base + N_TXTOFF(*header), 0, image, preparation);
+    default:
+        fprintf(stderr, "Unsupported magic value!\n");
+        return false;
+    }
+}
+
+/* handle_uselib
+ * @brief performs an intercepted uselib system call.
+ * @param context the run-aout instance.
+ * @param tracee the a.out host process.
+ *
+ * @details The tracee must be stopped at the entry of uselib. The
+ * system call itself is skipped and its result is set to the value
+ * returned by perform_uselib. Clears in_syscall, if the tracee ran
+ * _syscall_mmap_lib and left the syscall-stop thereby.
+ **/
+static void handle_uselib(runaout_t context, traceep tracee)
+{
+    pid_t pid = tracee->pid;
+    struct user_regs_struct regs, backup_regs;
+
+    // skip the actual system call, the result is set by perform_uselib.
+    ptrace(PTRACE_GETREGS, pid, NULL, &backup_regs);
+    backup_regs.orig_eax = -1;
+    ptrace(PTRACE_SETREGS, pid, NULL, &backup_regs);
+
+    backup_regs.eax = perform_uselib(context, tracee);
+    if ((int)backup_regs.eax == 0) {
+        tracee->libraries_loaded++;
+        context->stats.uselibs++;
+    }
+
+    // perform_uselib leaves the syscall-stop, if it runs _syscall_mmap_lib.
+    ptrace(PTRACE_GETREGS, pid, NULL, &regs);
+    ptrace(PTRACE_SETREGS, pid, NULL, &backup_regs);
+    if (regs.eip == SYM_SYSCALL_MMAP_LIB_RETURN) {
+        tracee->in_syscall = false;
+    }
+}
+
+/* reopen_fd
+ * @brief opens a file descriptor of the controller in a tracee.
+ * @param pid PID of the a.out host process.
+ * @param fd the file descriptor in the controller.
+ * @param target_fd the file descriptor in the tracee.
+ *
+ * @details Runs _reopen_fd in the tracee, which opens /proc/<controller>/fd/<fd>.
+ * Returns true on success.
+ **/
+static bool reopen_fd(pid_t pid, int fd, int target_fd)
+{
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "/proc/%d/fd/%d", getpid(), fd);
+
+    struct user_regs_struct regs;
+    ptrace(PTRACE_GETREGS, pid, NULL, &regs);
+    regs.ebx = set_data(pid, path, strlen(path) + 1);
+    regs.ecx = target_fd;
+    regs.eip = SYM_REOPEN_FD_CALL;
+    ptrace(PTRACE_SETREGS, pid, NULL, &regs);
+
+    int status = run_to_address(pid, SYM_REOPEN_FD_RETURN);
+    if (!WIFSTOPPED(status)) {
+        return false;
+    }
+    ptrace(PTRACE_GETREGS, pid, NULL, &regs);
+    if ((int)regs.eax != target_fd) {
+        fprintf(logfile, "Error: cannot open %s in %d: %ld\n", path, pid, regs.eax);
+        return false;
+    }
+    return true;
+}
+
+/* handle_execve
+ * @brief redirects an intercepted execve of an a.out executable to the trampoline.
+ * @param context the run-aout instance.
+ * @param tracee the a.out host process.
+ *
+ * @details The tracee must be stopped at the entry of execve. The image is
+ * prepared by the controller, thus uselib.conf is not read again. The
+ * parameter block and the image are handed over to the tracee using
+ * reopen_fd, then the system call is restarted with the path of the
+ * trampoline instead. Other executables (including the trampoline) are
+ * left to the kernel. Tracees that are not running the trampoline (e.g.
+ * a shell started by the a.out program) cannot be redirected.
+ * Clears in_syscall, if the tracee ran _reopen_fd and left the
+ * syscall-stop thereby.
+ **/
+static void handle_execve(runaout_t context, traceep tracee)
+{
+    pid_t pid = tracee->pid;
+    struct user_regs_struct regs, backup_regs;
+    ptrace(PTRACE_GETREGS, pid, NULL, &backup_regs);
+
+    char buffer[PATH_MAX], file[PATH_MAX + 32];
+    if (!tracee->aout_host || read_string(pid, backup_regs.ebx, buffer, sizeof(buffer)) < 0) {
+        return;
+    }
+    // relative paths are resolved in the working directory of the tracee.
+    if (buffer[0] == '/') {
+        snprintf(file, sizeof(file), "%s", buffer);
+    } else {
+        snprintf(file, sizeof(file), "/proc/%d/cwd/%s", pid, buffer);
+    }
+
+    struct member member;
+    if (!open_member(file, O_RDONLY | O_CLOEXEC, &member)) {
+        return;
+    }
+    int fd = member.fd;
+    struct exec header;
+    if (access(member.path, X_OK) != 0
+        || !read_header(&member, &header)
+        || !is_aout_header(&header)) {
+        close(fd);
+        return;
+    }
+
+    fprintf(logfile, "%d: redirecting execve of %s\n", pid, buffer);
+    print_aout_header(&header);
+
+    struct image image = { .fd = -1 };
+    if (!validate_header(&header) || !prepare_aout(context, &member, &header, &image, PREPARE_NOW)) {
+        image.fd = -1;
+    }
+    struct premap_table premap = { 0 };
+    unsigned int libraries = scan_image_libraries(context, &member, &image, &premap);
+    if (image.fd != fd) {
+        close(fd);
+    }
+
+    // skip the system call for now and restart it afterwards.
+    regs = backup_regs;
+    regs.orig_eax = -1;
+    ptrace(PTRACE_SETREGS, pid, NULL, &regs);
+
+    bool redirected = false;
+    if (image.fd != -1) {
+        // the pipe must have a writer, otherwise opening it blocks.
+        int param_pipe[2];
+        if (pipe2(param_pipe, O_CLOEXEC) != 0) {
+            param_pipe[0] = param_pipe[1] = -1;
+        }
+        if (param_pipe[0] != -1 && write_params(context, param_pipe[1], PARAM_IMAGE_FD, &image, &premap)) {
+            // running _reopen_fd leaves the syscall-stop.
+            tracee->in_syscall = false;
+            redirected = reopen_fd(pid, param_pipe[0], PARAM_FD)
+                && reopen_fd(pid, image.fd, PARAM_IMAGE_FD);
+        }
+        if (redirected) {
+            tracee->libraries_expected = libraries;
+        }
+        close(param_pipe[0]);
+        close(param_pipe[1]);
+        close(image.fd);
+    }
+
+    if (redirected) {
+        backup_regs.ebx = set_data(pid, context->trampoline, strlen(context->trampoline) + 1);
+        context->stats.execves++;
+        backup_regs.eip -= 2; // size of int 0x80
+        backup_regs.eax = backup_regs.orig_eax;
+    } else {
+        backup_regs.eax = -ENOEXEC;
+    }
+    backup_regs.orig_eax = -1;
+    ptrace(PTRACE_SETREGS, pid, NULL, &backup_regs);
+}
+
+/* is_trampoline
+ * @brief returns true if the process image of a tracee is the trampoline.
+ * @param context the run-aout instance.
+ * @param pid the PID of the process.
+ **/
+static bool is_trampoline(runaout_t context, pid_t pid)
+{
+    char path[PATH_MAX], exe[PATH_MAX];
+    snprintf(path, sizeof(path), "/proc/%d/exe", pid);
+    ssize_t length = readlink(path, exe, sizeof(exe) - 1);
+    if (length < 0) {
+        return false;
+    }
+    exe[length] = '\0';
+    return strcmp(exe, context->trampoline) == 0;
+}
+
+/* is_interrupted_syscall
+ * @brief returns true if the tracee is stopped in a system call, which the
+ * kernel would restart once the tracee is resumed (-ERESTART* in EAX).
+ * @param regs the registers of the tracee.
+ **/
+static bool is_interrupted_syscall(struct user_regs_struct *regs)
+{
+    return (long)regs->orig_eax >= 0
+        && (long)regs->eax <= -ERESTARTSYS
+        && (long)regs->eax >= -ERESTART_RESTARTBLOCK;
+}
+
+/* detach_tracee
+ * @brief stops tracing an a.out host process.
+ * @param context the run-aout instance.
+ * @param pid PID of the a.out host process.
+ * @param syscall_entry whether the tracee is stopped at a syscall-entry.
+ *
+ * @details Before detaching, the tracee installs the in-process uselib
+ * handler (see _install_uselib_handler), thus libraries loaded later on
+ * are still handled, just without the controller. A system call, which
+ * is about to be entered or was interrupted by the stop, is restarted.
+ **/
+static void detach_tracee(runaout_t context, pid_t pid, bool syscall_entry)
+{
+    struct user_regs_struct regs, backup_regs;
+    ptrace(PTRACE_GETREGS, pid, NULL, &backup_regs);
+    regs = backup_regs;
+
+    // the kernel must neither execute nor restart a system call
+    // for the injected call, we restart it manually afterwards.
+    regs.orig_eax = -1;
+    if (syscall_entry || is_interrupted_syscall(&backup_regs)) {
+        backup_regs.eip -= 2; // size of int 0x80
+        backup_regs.eax = (long)backup_regs.eax == -ERESTART_RESTARTBLOCK
+            ? SYS_restart_syscall
+            : backup_regs.orig_eax;
+    }
+    backup_regs.orig_eax = -1;
+
+    // call _install_uselib_handler in the tracee.
+    regs.eip = SYM_INSTALL_USELIB_HANDLER_CALL;
+    ptrace(PTRACE_SETREGS, pid, NULL, &regs);
+    run_to_address(pid, SYM_INSTALL_USELIB_HANDLER_RETURN);
+    ptrace(PTRACE_GETREGS, pid, NULL, &regs);
+    if (regs.eax != 0) {
+        fprintf(logfile, "Warning: installing the uselib handler failed: %ld\n", regs.eax);
+    }
+    ptrace(PTRACE_SETREGS, pid, NULL, &backup_regs);
+
+    fprintf(logfile, "detaching from %d\n", pid);
+    ptrace(PTRACE_DETACH, pid, NULL, NULL);
+    forget_tracee(context, pid);
+    context->stats.detaches++;
+}
+
+/* interrupt_tracee
+ * @brief stops a tracee with PTRACE_INTERRUPT, such that the controller can
+ * detach even if the tracee would not stop on its own (e.g. in seccomp mode).
+ * @param tracee the a.out host process.
+ * @param data pointer to the PID of the job to stop.
+ *
+ * @details Unlike a SIGSTOP, this is not visible to the a.out program.
+ **/
+static void interrupt_tracee(traceep tracee, void *data)
+{
+    if (tracee->job == *(pid_t *)data && !tracee->stop_requested) {
+        tracee->stop_requested = true;
+        ptrace(PTRACE_INTERRUPT, tracee->pid, NULL, NULL);
+    }
+}
+
+/* adopt_child
+ * @brief handles PTRACE_EVENT_FORK, PTRACE_EVENT_VFORK and PTRACE_EVENT_CLONE.
+ * @param context the run-aout instance.
+ * @param parent the a.out host process, which created a new process.
+ *
+ * @details The new process is traced automatically and inherits the state
+ * of its parent, e.g. the detach breakpoint, which is part of the copied
+ * memory. It is resumed once both the event and its initial
+ * PTRACE_EVENT_STOP have been reported.
+ **/
+static void adopt_child(runaout_t context, traceep parent)
+{
+    unsigned long pid;
+    ptrace(PTRACE_GETEVENTMSG, parent->pid, NULL, &pid);
+    fprintf(logfile, "%d created %lu\n", parent->pid, pid);
+
+    // add_tracee may move the parent in the table.
+    struct tracee_t state = *parent;
+    traceep child = get_tracee(&context->tracees, pid);
+    if (child == NULL) {
+        child = add_tracee(&context->tracees, pid);
+    }
+    if (child == NULL) {
+        fprintf(logfile, "Error: cannot trace %lu, out of memory!\n", pid);
+        kill(pid, SIGKILL);
+        return;
+    }
+    child->adopted = true;
+    if (child->job == 0) {
+        child->job = state.job;
+        find_job(context, state.job)->tracees++;
+    }
+    child->aout_host = state.aout_host;
+    child->libraries_loaded = state.libraries_loaded;
+    child->libraries_expected = state.libraries_expected;
+    child->breakpoint = state.breakpoint;
+
+    if (child->started) {
+        ptrace(resume_request(context), pid, NULL, NULL);
+    }
+}
+
+/* handle_breakpoint
+ * @brief handles a SIGTRAP signal-delivery-stop of a tracee.
+ * @param context the run-aout instance.
+ * @param tracee the a.out host process.
+ *
+ * @details SIGTRAPs caused by the controller (see PARAM_FLAG_ENTRY_TRAP
+ * and DETACH_ADDRESS) are suppressed, all others are delivered to the
+ * a.out program. Detaches if the detach breakpoint is hit.
+ * Returns the signal to deliver or -1 if the controller detached.
+ **/
+static int handle_breakpoint(runaout_t context, traceep tracee)
+{
+    unsigned long detach_value = context->options.detach_value;
+    bool detach_address = context->options.detach_trigger == DETACH_ADDRESS;
+    if (!detach_address && context->options.startup == 0) {
+        return SIGTRAP;
+    }
+
+    pid_t pid = tracee->pid;
+    struct user_regs_struct regs;
+    ptrace(PTRACE_GETREGS, pid, NULL, &regs);
+    if (regs.eip == SYM_START_LAUNCH) {
+        // the image is mapped, everything below the trampoline belongs to it.
+        if (context->options.startup != 0) {
+            report_prefaulted(context, pid, 0, SYM_START, "image");
+        }
+        // we can set the detach breakpoint now.
+        if (detach_address) {
+            tracee->breakpoint = set_breakpoint(pid, detach_value);
+        }
+        return 0;
+    }
+    if (detach_address && (unsigned long)regs.eip == detach_value + 1 && tracee->breakpoint != 0) {
+        clear_breakpoint(pid, detach_value, tracee->breakpoint);
+        regs.eip = detach_value;
+        ptrace(PTRACE_SETREGS, pid, NULL, &regs);
+        detach_tracee(context, pid, false);
+        return -1;
+    }
+    return SIGTRAP;
+}
+
+/* handle_stop
+ * @brief handles a ptrace stop of a tracee.
+ * @param context the run-aout instance.
+ * @param tracee the a.out host process.
+ * @param status the status returned by waitpid.
+ *
+ * @details Signal-delivery-stops are resumed with the signal, thus every
+ * signal except the controller's own SIGTRAPs reaches the a.out program.
+ * Group-stops (SIGSTOP, SIGTSTP, ...) are kept with PTRACE_LISTEN until
+ * the a.out program is continued by SIGCONT.
+ * Returns the signal to deliver when resuming the tracee, or -1 if the
+ * tracee must not be resumed (e.g. because the controller detached).
+ **/
+static int handle_stop(runaout_t context, traceep tracee, int status)
+{
+    pid_t pid = tracee->pid;
+    struct user_regs_struct regs;
+    int signal = WSTOPSIG(status);
+
+    switch (status >> 8) {
+    // syscall-enter-stop or syscall-exit-stop (PTRACE_SYSCALL)
+    case SIGTRAP | 0x80:
+        tracee->in_syscall = !tracee->in_syscall;
+        if (!tracee->in_syscall) {
+            break;
+        }
+        ptrace(PTRACE_GETREGS, pid, NULL, &regs);
+        fprintf(logfile, "%d: seeing syscall %ld\n", pid, regs.orig_eax);
+        if (regs.orig_eax == SYS_uselib) {
+            handle_uselib(context, tracee);
+        } else if (regs.orig_eax == SYS_execve) {
+            handle_execve(context, tracee);
+        } else if (context->options.detach_trigger == DETACH_SYSCALL && tracee->libraries_loaded > 0
+            && tracee->libraries_loaded >= tracee->libraries_expected) {
+            detach_tracee(context, pid, true);
+            return -1;
+        }
+        break;
+    // uselib or execve matched by the seccomp filter (PTRACE_CONT)
+    case SIGTRAP | (PTRACE_EVENT_SECCOMP << 8):
+        ptrace(PTRACE_GETREGS, pid, NULL, &regs);
+        if (regs.orig_eax == SYS_execve) {
+            handle_execve(context, tracee);
+        } else {
+            handle_uselib(context, tracee);
+        }
+        break;
+    // successful execve, the new image has its own libraries
+    case SIGTRAP | (PTRACE_EVENT_EXEC << 8):
+        fprintf(logfile, "%d: execve\n", pid);
+        tracee->aout_host = is_trampoline(context, pid);
+        tracee->libraries_loaded = 0;
+        tracee->breakpoint = 0;
+        break;
+    // new processes and threads
+    case SIGTRAP | (PTRACE_EVENT_FORK << 8):
+    case SIGTRAP | (PTRACE_EVENT_VFORK << 8):
+    case SIGTRAP | (PTRACE_EVENT_CLONE << 8):
+        adopt_child(context, tracee);
+        break;
+    // initial stop of a new process, PTRACE_INTERRUPT or SIGCONT after PTRACE_LISTEN
+    case SIGTRAP | (PTRACE_EVENT_STOP << 8):
+        if (!tracee->started) {
+            // wait for the event of its parent.
+            tracee->started = true;
+            if (!tracee->adopted) {
+                return -1;
+            }
+        } else if (tracee->stop_requested) {
+            detach_tracee(context, pid, false);
+            return -1;
+        }
+        break;
+    // group-stop
+    case SIGSTOP | (PTRACE_EVENT_STOP << 8):
+    case SIGTSTP | (PTRACE_EVENT_STOP << 8):
+    case SIGTTIN | (PTRACE_EVENT_STOP << 8):
+    case SIGTTOU | (PTRACE_EVENT_STOP << 8):
+        if (tracee->stop_requested) {
+            detach_tracee(context, pid, false);
+            return -1;
+        }
+        // stay stopped, but keep receiving events (e.g. SIGCONT).
+        ptrace(PTRACE_LISTEN, pid, NULL, NULL);
+        return -1;
+    // signal-delivery-stop
+    default:
+        if (signal == SIGTRAP) {
+            return handle_breakpoint(context, tracee);
+        }
+        return signal;
+    }
+
+    return 0;
+}
+
+/* handle_event
+ * @brief handles a status change of any child or tracee reported by waitpid.
+ * @param context the run-aout instance.
+ * @param pid the PID returned by waitpid.
+ * @param status the status returned by waitpid.
+ **/
+static void handle_event(runaout_t context, pid_t pid, int status)
+{
+    context->stats.stops++;
+
+    if (WIFEXITED(status) || WIFSIGNALED(status)) {
+        struct job *job = find_job(context, pid);
+        if (job != NULL) {
+            job->exited = true;
+            job->exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+        }
+        forget_tracee(context, pid);
+        return;
+    }
+
+    traceep tracee = get_tracee(&context->tracees, pid);
+    if (tracee == NULL) {
+        // a new process reported before the event of its parent.
+        tracee = add_tracee(&context->tracees, pid);
+    }
+    if (tracee == NULL) {
+        fprintf(logfile, "Error: cannot trace %d, out of memory!\n", pid);
+        kill(pid, SIGKILL);
+        return;
+    }
+    int signal = handle_stop(context, tracee, status);
+    if (signal >= 0) {
+        ptrace(resume_request(context), pid, NULL, (void *)signal);
+    }
+}
+
+/* runaout_create
+ * @brief creates a run-aout instance.
+ * @param options the options, NULL for defaults. The strings and the log
+ * must stay valid until runaout_destroy.
+ *
+ * @details Reads uselib.conf and prepares everything shared by all launches.
+ * Returns NULL and sets errno, if the trampoline cannot be found or the
+ * options conflict (EINVAL, DETACH_SYSCALL cannot be used with use_seccomp).
+ **/
+runaout_t runaout_create(const struct runaout_options *options)
+{
+    runaout_t context = calloc(1, sizeof(struct runaout_context));
+    if (context == NULL) {
+        return NULL;
+    }
+    if (options != NULL) {
+        context->options = *options;
+    }
+    // there are no stops for other system calls with seccomp.
+    if (context->options.use_seccomp && !context->options.in_process
+        && context->options.detach_trigger == DETACH_SYSCALL) {
+        free(context);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    const char *trampoline = context->options.trampoline;
+    if (realpath(trampoline != NULL ? trampoline : "./trampoline", context->trampoline) == NULL) {
+        int error = errno;
+        free(context);
+        errno = error;
+        return NULL;
+    }
+
+    context->log = context->options.log;
+    if (context->log == NULL) {
+        context->log = fopen("/dev/null", "w");
+        context->owns_log = true;
+    }
+    logfile = context->log;
+
+    // uselib.conf is read while the first image is prepared.
+    pthread_mutex_init(&context->preload_lock, NULL);
+    int error = start_thread(&context->preload, preload, context);
+    if (error != 0) {
+        preload(context);
+    }
+    context->preloading = error == 0;
+
+    context->lazy = context->options.lazy_load && lazy_loading_available();
+    if (context->options.lazy_load && !context->lazy) {
+        fprintf(stderr, "Warning: userfaultfd with fork events is not available, images are converted eagerly.\n");
+    }
+
+    context->cache.dir = -1;
+    if (context->options.cache_dir != NULL
+        && !open_image_cache(&context->cache, context->options.cache_dir, context->options.cache_limit)) {
+        fprintf(stderr, "Warning: cannot open image cache '%s', converting every launch. %s\n",
+            context->options.cache_dir, strerror(errno));
+    }
+    return context;
+}
+
+/* finish_job
+ * @brief releases the resources of a job, which has exited or is abandoned.
+ * @param context the run-aout instance.
+ * @param job the job.
+ **/
+static void finish_job(runaout_t context, struct job *job)
+{
+    if (job->conversion != NULL) {
+        finish_conversion(job->conversion);
+        job->conversion = NULL;
+    }
+    if (job->loader != NULL) {
+        unsigned int pages;
+        unsigned long faults = finish_lazy_loader(job->loader, &pages);
+        fprintf(logfile, "lazy loading: %lu of %u pages of pid %d faulted in\n", faults, pages, job->pid);
+        context->stats.lazy_faults += faults;
+        job->loader = NULL;
+    }
+}
+
+/* kill_tracee
+ * @brief for_each_tracee callback of runaout_destroy.
+ **/
+static void kill_tracee(traceep tracee, void *data)
+{
+    (void)data;
+    kill(tracee->pid, SIGKILL);
+}
+
+/* runaout_destroy
+ * @brief releases a run-aout instance.
+ * @param context the run-aout instance.
+ *
+ * @details Processes that are still traced are killed, just like
+ * PTRACE_O_EXITKILL would do when the controller exits.
+ **/
+void runaout_destroy(runaout_t context)
+{
+    for_each_tracee(&context->tracees, kill_tracee, NULL);
+    for (int i = 0; i < context->njobs; i++) {
+        finish_job(context, &context->jobs[i]);
+    }
+    wait_preload(context);
+    pthread_mutex_destroy(&context->preload_lock);
+    free_tracees(&context->tracees);
+    free_entries(&context->uselib);
+    close_image_cache(&context->cache);
+    free_library_cache(&context->libraries);
+    free(context->jobs);
+    if (context->owns_log) {
+        if (logfile == context->log) {
+            logfile = NULL;
+        }
+        fclose(context->log);
+    }
+    free(context);
+}
+
+/* child_failed
+ * @brief reports an error of the forked child and exits.
+ * @param message the message.
+ *
+ * @details The controller may be multithreaded, thus the child may only
+ * call async-signal-safe functions before execve.
+ **/
+static void child_failed(const char *message)
+{
+    write(STDERR_FILENO, message, strlen(message));
+    _exit(EXIT_FAILURE);
+}
+
+/* runaout_launch
+ * @brief starts an a.out program.
+ * @param context the run-aout instance.
+ * @param argv NULL terminated arguments, argv[0] is the path of the a.out executable.
+ *
+ * @details The image is prepared by the caller, then a child process runs the
+ * trampoline, which loads the image. Non-QMAGIC images are converted by
+ * another thread while the trampoline starts, unless they are cached or
+ * loaded lazily. Unless in_process is set, the child is
+ * traced by the calling thread from now on, see runaout_wait.
+ * Returns the PID of the a.out host process or -1 with errno set.
+ **/
+pid_t runaout_launch(runaout_t context, char *const argv[])
+{
+    logfile = context->log;
+
+    // open the a.out binary, which may be an archive member.
+    struct member member;
+	if (!open_file(context, argv[0], &member, NULL)) {
+		fprintf(stderr, "Error open: input file not found or not accessible!\n");
+		return -1;
+	}
+    int fd = member.fd;
+
+    // check the a.out header and prepare the image, if necessary.
+    struct exec header;
+    struct image image = { .fd = -1 };
+    if (!read_header(&member, &header)
+        || !validate_header(&header)
+        || !prepare_aout(context, &member, &header, &image, context->lazy ? PREPARE_LAZY : PREPARE_PIPELINED)) {
+        image.fd = -1;
+        image.pending = false;
+    }
+    // optional: find the libraries of the executable, the trampoline maps them with the image.
+    struct premap_table premap = { 0 };
+    unsigned int libraries = scan_image_libraries(context, &member, &image, &premap);
+    // a pending image is converted from the a.out file later on.
+    int source = image.pending ? fd : -1;
+    if (image.fd != fd && source == -1) {
+        close(fd);
+    }
+    if (image.fd == -1) {
+        errno = ENOEXEC;
+        return -1;
+    }
+    int target_fd = image.fd;
+
+    // prepare actual execution:
+    // Here we fork and in the child process, we execute the trampoline binary,
+    // which in turn loads the a.out binary, with the help of the parent process (controller)
+    int param_pipe[2], sync_pipe[2], ready_pipe[2] = { -1, -1 };
+    if (pipe2(param_pipe, O_CLOEXEC) != 0) {
+        close(source);
+        close(target_fd);
+        return -1;
+    }
+    if (pipe2(sync_pipe, O_CLOEXEC) != 0
+        || (image.lazy && pipe2(ready_pipe, O_CLOEXEC) != 0)) {
+        close(param_pipe[0]);
+        close(param_pipe[1]);
+        close(sync_pipe[0]);
+        close(sync_pipe[1]);
+        close(source);
+        close(target_fd);
+        return -1;
+    }
+
+	pid_t aout_host_process = fork();
+	if (aout_host_process == 0) {
+        // child process / trampoline
+        if (context->options.process_group) {
+            setpgid(0, 0);
+        }
+
+        // wait until the controller is attached (end of file on sync_pipe).
+        char sync;
+        close(sync_pipe[1]);
+        while (read(sync_pipe[0], &sync, 1) == -1 && errno == EINTR);
+
+        // hand the read end of the parameter pipe and the image to the trampoline,
+        // all other file descriptors of the controller are closed by execve.
+        if (dup2(param_pipe[0], PARAM_FD) != PARAM_FD
+            || dup2(target_fd, PARAM_IMAGE_FD) != PARAM_IMAGE_FD
+            || (image.lazy && dup2(ready_pipe[1], PARAM_READY_FD) != PARAM_READY_FD)) {
+            child_failed("run-aout: cannot pass the parameter block to the trampoline!\n");
+        }
+
+        // only stop for uselib and execve, the filter is kept across execve.
+        // The filter also outlives a detach, SECCOMP_RET_TRACE without a tracer
+        // fails the system call, thus execve is only traced if we never detach.
+        // uselib is taken over by the in-process handler (SECCOMP_RET_TRAP) then.
+        bool trace_execve = context->options.detach_trigger == DETACH_NEVER;
+        if (context->options.use_seccomp && !context->options.in_process
+            && !install_uselib_filter(SECCOMP_RET_TRACE, trace_execve)) {
+            child_failed("run-aout: cannot install the seccomp filter!\n");
+        }
+
+		// launch: we call the trampoline with all arguments passed after the a.out file name.
+		execv(context->trampoline, argv);
+        child_failed("run-aout: cannot execute the trampoline!\n");
+	}
+
+    // parent process / controller
+    close(param_pipe[0]);
+    close(sync_pipe[0]);
+    close(ready_pipe[1]);
+    if (aout_host_process == -1) {
+        close(param_pipe[1]);
+        close(sync_pipe[1]);
+        close(ready_pipe[0]);
+        close(source);
+        close(target_fd);
+        return -1;
+    }
+    if (context->options.process_group) {
+        setpgid(aout_host_process, aout_host_process);
+    }
+
+    // the trampoline blocks until the parameter block is available.
+    bool written;
+    struct lazy_loader *loader = NULL;
+    struct conversion *conversion = NULL;
+    if (image.pending) {
+        // the conversion writes the block once the image is complete,
+        // it owns the a.out file, the image and the parameter pipe now.
+        conversion = start_conversion(context, source, &header, &image, param_pipe[1], &premap);
+        written = conversion != NULL;
+    } else {
+        written = write_params(context, param_pipe[1], PARAM_IMAGE_FD, &image, &premap);
+        if (written && image.lazy) {
+            // the loader acknowledges on the parameter pipe, it owns its write end now.
+            loader = start_lazy_loader(aout_host_process, &header, &image, ready_pipe[0], param_pipe[1]);
+            written = loader != NULL;
+        } else {
+            close(ready_pipe[0]);
+            close(param_pipe[1]);
+        }
+        close(target_fd);
+    }
+
+    struct job *job = add_job(context, aout_host_process);
+    if (job != NULL) {
+        job->loader = loader;
+        job->conversion = conversion;
+    }
+    if (!written || job == NULL) {
+        int error = job == NULL ? ENOMEM : (errno != 0 ? errno : EIO);
+        kill(aout_host_process, SIGKILL);
+        close(sync_pipe[1]);
+        waitpid(aout_host_process, NULL, 0);
+        if (job != NULL) {
+            finish_job(context, job);
+            remove_job(context, aout_host_process);
+        } else {
+            if (loader != NULL) {
+                unsigned int pages;
+                finish_lazy_loader(loader, &pages);
+            }
+            if (conversion != NULL) {
+                finish_conversion(conversion);
+            }
+        }
+        errno = error;
+        return -1;
+    }
+
+    // the a.out process is not traced, just let it run.
+    if (context->options.in_process) {
+        close(sync_pipe[1]);
+        context->stats.launches++;
+        return aout_host_process;
+    }
+
+    // attach with PTRACE_SEIZE, which is required for PTRACE_LISTEN and
+    // PTRACE_INTERRUPT, and stop the process before it runs the trampoline.
+    int options = PTRACE_O_EXITKILL
+        | PTRACE_O_TRACESYSGOOD
+        | PTRACE_O_TRACEFORK
+        | PTRACE_O_TRACEVFORK
+        | PTRACE_O_TRACECLONE
+        | PTRACE_O_TRACEEXEC;
+    if (context->options.use_seccomp) {
+        options |= PTRACE_O_TRACESECCOMP;
+    }
+    int status;
+    if (ptrace(PTRACE_SEIZE, aout_host_process, NULL, options) != 0
+        || ptrace(PTRACE_INTERRUPT, aout_host_process, NULL, NULL) != 0) {
+        int error = errno;
+        fprintf(stderr, "ptrace(PTRACE_SEIZE) error! %s\n", strerror(error));
+        kill(aout_host_process, SIGKILL);
+        close(sync_pipe[1]);
+        waitpid(aout_host_process, NULL, 0);
+        finish_job(context, job);
+        remove_job(context, aout_host_process);
+        errno = error;
+        return -1;
+    }
+    waitpid_printf(aout_host_process, &status);
+    close(sync_pipe[1]);
+
+    // every stop wakes up the controller, keep both close together. Pairs are
+    // spread by the number of launches, the controller (the calling thread)
+    // serves all jobs and is only pinned while it traces a single one.
+    if (compute_placement(context->options.placement, context->stats.launches, &job->placement)
+        && !apply_placement(&job->placement, aout_host_process, context->njobs == 1)) {
+        fprintf(logfile, "Warning: cannot set CPU affinity! %s\n", strerror(errno));
+    }
+
+    fprintf(logfile, "pid = %d\n", aout_host_process);
+    traceep root = add_tracee(&context->tracees, aout_host_process);
+    if (root == NULL) {
+        kill(aout_host_process, SIGKILL);
+        waitpid(aout_host_process, NULL, 0);
+        finish_job(context, job);
+        remove_job(context, aout_host_process);
+        errno = ENOMEM;
+        return -1;
+    }
+    root->job = aout_host_process;
+    root->aout_host = true;
+    root->libraries_expected = libraries;
+    root->started = true;
+    root->adopted = true;
+    job->tracees = 1;
+
+    ptrace(resume_request(context), aout_host_process, NULL, NULL);
+    context->stats.launches++;
+    return aout_host_process;
+}
+
+/* runaout_wait
+ * @brief controller "part" of the a.out execution, waits for a launched program.
+ * @param context the run-aout instance.
+ * @param pid the PID returned by runaout_launch.
+ * @param exit_code set to the exit code (or 128 + signal number) of the program.
+ *
+ * @details The trampoline loads the a.out executable on its own using
+ * the parameter block, thus we only wait for uselib syscalls and
+ * call perform_uselib. Processes created by the a.out program are traced
+ * as well, every event of any tracee is dispatched by a single waitpid loop.
+ * Returns once the program exited and none of its processes are traced anymore.
+ * Returns -1 with errno = EINTR, if the calling thread is interrupted by a
+ * signal, e.g. to call runaout_detach. Events of other launches (and other
+ * children, unless process_group is set) are handled in the meantime.
+ **/
+int runaout_wait(runaout_t context, pid_t pid, int *exit_code)
+{
+    logfile = context->log;
+    struct job *job = find_job(context, pid);
+    if (job == NULL) {
+        errno = ECHILD;
+        return -1;
+    }
+
+    pid_t wait_pid = context->options.process_group ? -pid : -1;
+    while (!job->exited || job->tracees > 0) {
+        int status;
+        pid_t current = waitpid_printf(wait_pid, &status);
+        if (current == -1) {
+            if (errno != ECHILD) {
+                return -1;
+            }
+            // no children and tracees left.
+            break;
+        }
+        handle_event(context, current, status);
+        job = find_job(context, pid);
+    }
+
+    *exit_code = job->exit_code;
+    finish_job(context, job);
+    remove_job(context, pid);
+    return 0;
+}
+
+/* runaout_detach
+ * @brief detaches from all processes of a launched program (see DETACH_TIMEOUT).
+ * @param context the run-aout instance.
+ * @param pid the PID returned by runaout_launch.
+ *
+ * @details The processes are interrupted and detached from, once
+ * their stops are handled by runaout_wait. With use_seccomp, this requires
+ * a detach_trigger other than DETACH_NEVER (see runaout_launch), otherwise
+ * execve would fail after the detach and -1 is returned with errno EPERM.
+ **/
+int runaout_detach(runaout_t context, pid_t pid)
+{
+    if (find_job(context, pid) == NULL) {
+        errno = ECHILD;
+        return -1;
+    }
+    if (context->options.use_seccomp && context->options.detach_trigger == DETACH_NEVER) {
+        errno = EPERM;
+        return -1;
+    }
+    for_each_tracee(&context->tracees, interrupt_tracee, &pid);
+    return 0;
+}
+
+/* runaout_kill
+ * @brief sends a signal to a launched program.
+ * @param context the run-aout instance.
+ * @param pid the PID returned by runaout_launch.
+ * @param signal the signal number.
+ *
+ * @details If process_group is set, the signal is sent to the whole group.
+ **/
+int runaout_kill(runaout_t context, pid_t pid, int signal)
+{
+    if (find_job(context, pid) == NULL) {
+        errno = ECHILD;
+        return -1;
+    }
+    return kill(context->options.process_group ? -pid : pid, signal);
+}
+
+/* runaout_placement
+ * @brief returns the CPU placement of a launched program (see compute_placement).
+ * @param context the run-aout instance.
+ * @param pid the PID returned by runaout_launch.
+ * @param placement the placement to fill.
+ **/
+bool runaout_placement(runaout_t context, pid_t pid, struct placement *placement)
+{
+    struct job *job = find_job(context, pid);
+    if (job == NULL) {
+        return false;
+    }
+    *placement = job->placement;
+    return true;
+}
+
+/* runaout_stats
+ * @brief returns the statistics of a run-aout instance.
+ * @param context the run-aout instance.
+ * @param stats the statistics to fill.
+ **/
+void runaout_stats(runaout_t context, struct runaout_stats *stats)
+{
+    *stats = context->stats;
+    stats->cache_hits = context->cache.hits;
+    stats->cache_misses = context->cache.misses;
+    stats->cache_evictions = context->cache.evictions;
+    stats->library_hits = context->libraries.hits;
+    stats->library_misses = context->libraries.misses;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file librunaout.h
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief embeddable API of run-aout, launches a.out programs from a host process.
+ *
+ * @details A context holds everything needed for any number of launches:
+ * the uselib.conf table, the parameter block template, the traced processes
+ * and statistics. All calls for a context must be made by the same thread,
+ * because the kernel only accepts ptrace requests from the tracer thread.
+ * Functions report errors by returning -1 (or NULL) and setting errno.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+#include "affinity.h"
+
+#ifndef LIBRUNAOUT_H
+#define LIBRUNAOUT_H
+
+// conditions for detaching from the tracee (-d)
+enum detach_trigger {
+    DETACH_NEVER,
+    DETACH_SYSCALL, // first non-uselib syscall after every library named in the image was loaded
+                    // (see scan_libraries), not with use_seccomp
+    DETACH_ADDRESS, // the tracee reaches detach_value
+    DETACH_TIMEOUT  // detach_value seconds have passed, the caller calls runaout_detach
+};
+
+// startup modes, which remove page faults after the bootstrap
+#define STARTUP_PREFAULT 0x1 // populate image, bss and libraries when they are mapped
+#define STARTUP_HUGEPAGE 0x2 // use transparent huge pages for bss
+#define STARTUP_MLOCK    0x4 // populate and lock image, bss and libraries
+
+struct runaout_options {
+    const char *trampoline;  /* path of the trampoline, NULL = "./trampoline" */
+    const char *uselib_conf; /* path of uselib.conf, NULL = "uselib.idx" or "uselib.conf" */
+    const char *uselib_index; /* path of the compiled index, NULL = "uselib.idx", ignored if older than uselib.conf (see compile_uselib_index) */
+    FILE *log;               /* diagnostic output, NULL = none */
+    bool use_seccomp;        /* only stop for uselib and execve (execve only with DETACH_NEVER) */
+    bool in_process;         /* emulate uselib without tracing */
+    bool process_group;      /* launch every program in its own process group */
+    enum detach_trigger detach_trigger;
+    unsigned long detach_value;
+    enum placement_policy placement; /* PLACEMENT_NONE (default) = no pinning, children inherit the tracee's CPU */
+    const char *cache_dir;     /* directory of converted images, NULL = no cache */
+    unsigned long cache_limit; /* maximum size of the image cache in bytes, 0 = 64 MB */
+    bool lazy_load;            /* fill non-QMAGIC images on first access (userfaultfd) */
+    unsigned int startup;      /* STARTUP_* flags */
+    const char *bundle;        /* programs and libraries are looked up in this bundle first, NULL = none */
+    bool premap_libraries;     /* map the libraries named in the executable at startup */
+};
+
+struct runaout_stats {
+    unsigned long launches;
+    unsigned long stops;    /* ptrace stops and exits handled */
+    unsigned long uselibs;  /* libraries loaded by the controller */
+    unsigned long premapped; /* libraries mapped by the trampoline at startup */
+    unsigned long execves;  /* execve calls redirected to the trampoline */
+    unsigned long detaches;
+    unsigned long cache_hits;      /* converted images found in the image cache */
+    unsigned long cache_misses;    /* converted images added to the image cache */
+    unsigned long cache_evictions;
+    unsigned long library_hits;    /* uselib lookups answered by the library cache */
+    unsigned long library_misses;  /* uselib lookups that opened a file */
+    unsigned long lazy_faults;     /* pages of lazily loaded images filled on first access */
+    unsigned long prefaulted;      /* pages made resident by the startup modes */
+};
+
+typedef struct runaout_context *runaout_t;
+
+runaout_t runaout_create(const struct runaout_options *options);
+void runaout_destroy(runaout_t context);
+pid_t runaout_launch(runaout_t context, char *const argv[]);
+int runaout_wait(runaout_t context, pid_t pid, int *exit_code);
+int runaout_detach(runaout_t context, pid_t pid);
+int runaout_kill(runaout_t context, pid_t pid, int signal);
+bool runaout_placement(runaout_t context, pid_t pid, struct placement *placement);
+void runaout_stats(runaout_t context, struct runaout_stats *stats);
+
+#endif
@@ -0,0 +1,276 @@
+/**
+ * @file memory.c
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief bulk access to the memory of the a.out host process.
+ *
+ * @details Uses process_vm_readv/process_vm_writev to transfer whole
+ * buffers with a single system call. PTRACE_PEEKDATA/PTRACE_POKEDATA
+ * are only used for the remainder that could not be transferred, e.g.
+ * writes to read-only pages like the text of the trampoline.
+ */
+
+#define _GNU_SOURCE // process_vm_readv, process_vm_writev
+#undef __x86_64__ // undefine x86_64 env to make vscode
+				  // use 32-bit header files
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include <sys/ptrace.h>
+#include <sys/uio.h>
+
+#include "memory.h"
+
+// maximum number of remote pages per process_vm_readv/writev call.
+#define MAX_IOV_PAGES 64
+
+union long_char {
+    long value;
+    char chars[sizeof(long)];
+};
+
+/* split_pages
+ * @brief splits a remote address range at page boundaries.
+ * @param address start of the range.
+ * @param length length of the range.
+ * @param iov array of at least MAX_IOV_PAGES elements.
+ *
+ * @details process_vm_readv/writev only report partial transfers at the
+ * granularity of iovec elements, with one element per page the transfer
+ * stops exactly at the first inaccessible page.
+ * Returns the number of elements used.
+ **/
+static int split_pages(unsigned long address, size_t length, struct iovec *iov)
+{
+    long page_size = getpagesize();
+    int count = 0;
+    while (length > 0 && count < MAX_IOV_PAGES) {
+        size_t chunk = page_size - (address % page_size);
+        if (chunk > length)
+            chunk = length;
+        iov[count].iov_base = (void *)address;
+        iov[count].iov_len = chunk;
+        count++;
+        address += chunk;
+        length -= chunk;
+    }
+    return count;
+}
+
+/* transfer
+ * @brief copies between local and remote memory using process_vm_readv/writev.
+ * @param pid the PID of the process to access.
+ * @param address the remote address.
+ * @param buffer the local buffer.
+ * @param length the number of bytes to transfer.
+ * @param write true to write to the remote process.
+ *
+ * Returns the number of bytes transferred.
+ **/
+static size_t transfer(pid_t pid, unsigned long address, char *buffer, size_t length, bool write)
+{
+    struct iovec local, remote[MAX_IOV_PAGES];
+    size_t done = 0;
+
+    while (done < length) {
+        int count = split_pages(address + done, length - done, remote);
+        local.iov_base = buffer + done;
+        local.iov_len = 0;
+        for (int i = 0; i < count; i++)
+            local.iov_len += remote[i].iov_len;
+
+        ssize_t r = write
+            ? process_vm_writev(pid, &local, 1, remote, count, 0)
+            : process_vm_readv(pid, &local, 1, remote, count, 0);
+        if (r <= 0)
+            break;
+        done += r;
+        if ((size_t)r < local.iov_len)
+            break;
+    }
+    return done;
+}
+
+/* peek_memory
+ * @brief reads process memory one long at a time using PTRACE_PEEKDATA.
+ * @param pid the PID of the process to access.
+ * @param address the address to read from.
+ * @param buffer non-NULL buffer to write to.
+ * @param length the number of bytes to read.
+ *
+ * Returns the number of bytes read.
+ **/
+static size_t peek_memory(pid_t pid, unsigned long address, char *buffer, size_t length)
+{
+    union long_char data;
+    size_t done = 0;
+
+    while (done < length) {
+        unsigned long word = (address + done) & ~(sizeof(long) - 1);
+        size_t offset = address + done - word;
+        size_t chunk = sizeof(long) - offset;
+        if (chunk > length - done)
+            chunk = length - done;
+
+        errno = 0;
+        data.value = ptrace(PTRACE_PEEKDATA, pid, word, NULL);
+        if (errno != 0)
+            break;
+        memcpy(buffer + done, data.chars + offset, chunk);
+        done += chunk;
+    }
+    return done;
+}
+
+/* poke_memory
+ * @brief writes process memory one long at a time using PTRACE_POKEDATA.
+ * @param pid the PID of the process to access.
+ * @param address the address to write to.
+ * @param buffer non-NULL buffer to read from.
+ * @param length the number of bytes to write.
+ *
+ * @details Partial words at the start and the end are read first, such
+ * that the bytes next to the buffer are preserved.
+ * Returns the number of bytes written.
+ **/
+static size_t poke_memory(pid_t pid, unsigned long address, const char *buffer, size_t length)
+{
+    union long_char data;
+    size_t done = 0;
+
+    while (done < length) {
+        unsigned long word = (address + done) & ~(sizeof(long) - 1);
+        size_t offset = address + done - word;
+        size_t chunk = sizeof(long) - offset;
+        if (chunk > length - done)
+            chunk = length - done;
+
+        if (chunk < sizeof(long)) {
+            errno = 0;
+            data.value = ptrace(PTRACE_PEEKDATA, pid, word, NULL);
+            if (errno != 0)
+                break;
+        }
+        memcpy(data.chars + offset, buffer + done, chunk);
+        if (ptrace(PTRACE_POKEDATA, pid, word, data.value) != 0)
+            break;
+        done += chunk;
+    }
+    return done;
+}
+
+/* read_memory
+ * @brief reads data from process memory.
+ * @param pid the PID of the process to access.
+ * @param address the address to read from.
+ * @param buffer non-NULL buffer to write to.
+ * @param length the number of bytes to read.
+ *
+ * Returns the number of bytes read or -1 if nothing could be read.
+ **/
+ssize_t read_memory(pid_t pid, unsigned long address, void *buffer, size_t length)
+{
+    size_t done = transfer(pid, address, buffer, length, false);
+    if (done < length) {
+        // fall back to ptrace, e.g. for pages without PROT_READ.
+        done += peek_memory(pid, address + done, (char *)buffer + done, length - done);
+    }
+    return done == 0 && length > 0 ? -1 : (ssize_t)done;
+}
+
+/* write_memory
+ * @brief writes data to process memory.
+ * @param pid the PID of the process to access.
+ * @param address the address to write to.
+ * @param buffer non-NULL buffer to read from.
+ * @param length the number of bytes to write.
+ *
+ * Returns the number of bytes written or -1 if nothing could be written.
+ **/
+ssize_t write_memory(pid_t pid, unsigned long address, const void *buffer, size_t length)
+{
+    size_t done = transfer(pid, address, (char *)buffer, length, true);
+    if (done < length) {
+        // fall back to ptrace, e.g. for pages without PROT_WRITE.
+        done += poke_memory(pid, address + done, (const char *)buffer + done, length - done);
+    }
+    return done == 0 && length > 0 ? -1 : (ssize_t)done;
+}
+
+/* read_string
+ * @brief reads a NUL-terminated string from process memory.
+ * @param pid the PID of the process to access.
+ * @param address the address of the string.
+ * @param buffer non-NULL buffer to write to.
+ * @param size the size of buffer.
+ *
+ * @details Reads at most one page per step and stops at the first NUL,
+ * thus short strings only cost a single system call. buffer is always
+ * NUL-terminated.
+ * Returns the length of the string or -1 if it could not be read or is
+ * too long for buffer.
+ **/
+ssize_t read_string(pid_t pid, unsigned long address, char *buffer, size_t size)
+{
+    long page_size = getpagesize();
+    size_t done = 0;
+
+    if (size == 0)
+        return -1;
+
+    while (done < size - 1) {
+        size_t chunk = page_size - ((address + done) % page_size);
+        if (chunk > size - 1 - done)
+            chunk = size - 1 - done;
+
+        ssize_t r = read_memory(pid, address + done, buffer + done, chunk);
+        if (r <= 0)
+            break;
+        char *end = memchr(buffer + done, '\0', r);
+        if (end != NULL)
+            return end - buffer;
+        done += r;
+        if ((size_t)r < chunk)
+            break;
+    }
+
+    buffer[done] = '\0';
+    return -1;
+}
+
+/* resident_pages
+ * @brief counts the pages of an address range that are mapped into the
+ * page tables of a process, i.e. pages that do not fault on first access.
+ * @param pid the process.
+ * @param start start of the range.
+ * @param end end of the range (exclusive).
+ *
+ * @details Sums the Rss of all mappings within the range, as reported
+ * by /proc/<pid>/smaps. Returns 0 if smaps cannot be read.
+ **/
+unsigned long resident_pages(pid_t pid, unsigned long start, unsigned long end)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/smaps", pid);
+    FILE *smaps = fopen(path, "r");
+    if (smaps == NULL) {
+        return 0;
+    }
+
+    unsigned long total = 0, from = 0, to = 0, rss;
+    char line[256];
+    while (fgets(line, sizeof(line), smaps) != NULL) {
+        if (sscanf(line, "%lx-%lx ", &from, &to) == 2) {
+            continue;
+        }
+        if (sscanf(line, "Rss: %lu kB", &rss) == 1 && from >= start && to <= end) {
+            total += rss;
+        }
+    }
+    fclose(smaps);
+    return total * 1024 / getpagesize();
+}
@@ -0,0 +1,21 @@
+/**
+ * @file memory.h
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief bulk access to the memory of the a.out host process.
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+#ifndef MEMORY_H
+#define MEMORY_H
+
+ssize_t read_memory(pid_t pid, unsigned long address, void *buffer, size_t length);
+ssize_t write_memory(pid_t pid, unsigned long address, const void *buffer, size_t length);
+ssize_t read_string(pid_t pid, unsigned long address, char *buffer, size_t size);
+unsigned long resident_pages(pid_t pid, unsigned long start, unsigned long end);
+
+#endif
@@ -0,0 +1,206 @@
+/**
+ * @file object.c
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief read-only, zero-copy view of an a.out file.
+ *
+ * @details The file (or archive member) is mapped once and the header, the
+ * sections, the relocations, the symbol table and the string table are
+ * accessed in place, thus a lookup costs no I/O beyond page faults.
+ * Every section is checked against the size of the file when the object
+ * is opened, sections that do not fit are treated as missing. Symbol names
+ * are checked against the string table whenever they are looked up.
+ */
+
+#undef __x86_64__ // undefine x86_64 env to make vscode
+				  // use 32-bit header files
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "object.h"
+
+/* section
+ * @brief returns a pointer to a part of the file or NULL if it does not fit.
+ * @param object the a.out object.
+ * @param offset offset of the part in the file.
+ * @param length length of the part.
+ **/
+static const char *section(struct aout_object *object, unsigned long long offset, unsigned long long length)
+{
+    if (offset > object->size || length > object->size - offset) {
+        return NULL;
+    }
+    return object->file + offset;
+}
+
+/* open_object
+ * @brief maps an a.out file read-only.
+ * @param fd file descriptor of the file or archive, it may be closed afterwards.
+ * @param offset offset of the a.out file (see struct member).
+ * @param size size of the a.out file.
+ * @param object the object to fill.
+ *
+ * @details Only the header must be complete, the magic is not checked
+ * (see validate_header). Returns false and sets errno on error.
+ **/
+bool open_object(int fd, off_t offset, off_t size, struct aout_object *object)
+{
+    memset(object, 0, sizeof(struct aout_object));
+    // pages beyond the end of the file raise SIGBUS, do not trust archive headers.
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        return false;
+    }
+    if (size < (off_t)sizeof(struct exec) || offset > st.st_size || size > st.st_size - offset) {
+        errno = ENOEXEC;
+        return false;
+    }
+
+    off_t page_offset = offset & ~(off_t)(sysconf(_SC_PAGESIZE) - 1);
+    object->mapping_length = size + (offset - page_offset);
+    object->mapping = mmap(NULL, object->mapping_length, PROT_READ, MAP_PRIVATE, fd, page_offset);
+    if (object->mapping == MAP_FAILED) {
+        object->mapping = NULL;
+        return false;
+    }
+    object->file = (const char *)object->mapping + (offset - page_offset);
+    object->size = size;
+    object->header = (const struct exec *)object->file;
+
+    // like N_TXTOFF and friends, but without overflows of corrupt headers.
+    const struct exec *header = object->header;
+    object->text_offset = N_TXTOFF(*header);
+    object->data_offset = object->text_offset + header->a_text;
+    object->trel_offset = object->data_offset + header->a_data;
+    object->drel_offset = object->trel_offset + header->a_trsize;
+    object->symbols_offset = object->drel_offset + header->a_drsize;
+    object->strings_offset = object->symbols_offset + header->a_syms;
+
+    object->symbols = (const struct nlist *)section(object, object->symbols_offset, header->a_syms);
+    if (object->symbols != NULL) {
+        object->nsymbols = header->a_syms / sizeof(struct nlist);
+    }
+
+    // the string table starts with its own size, including the size field.
+    unsigned int strings_size;
+    const char *strings = section(object, object->strings_offset, sizeof(strings_size));
+    if (object->symbols != NULL && strings != NULL) {
+        memcpy(&strings_size, strings, sizeof(strings_size));
+        if (strings_size >= sizeof(strings_size) && section(object, object->strings_offset, strings_size) != NULL) {
+            object->strings = strings;
+            object->strings_size = strings_size;
+        }
+    }
+    return true;
+}
+
+/* close_object
+ * @brief unmaps an a.out file, all pointers into it become invalid.
+ * @param object the a.out object.
+ **/
+void close_object(struct aout_object *object)
+{
+    if (object->mapping != NULL) {
+        munmap(object->mapping, object->mapping_length);
+    }
+    memset(object, 0, sizeof(struct aout_object));
+}
+
+/* object_text
+ * @brief returns the text section or NULL if the file is truncated.
+ * @param object the a.out object.
+ * @param size set to the size of the section.
+ *
+ * @details The text section of QMAGIC files includes the header.
+ **/
+const void *object_text(struct aout_object *object, size_t *size)
+{
+    *size = object->header->a_text;
+    return section(object, object->text_offset, object->header->a_text);
+}
+
+/* object_data
+ * @brief returns the data section or NULL if the file is truncated.
+ * @param object the a.out object.
+ * @param size set to the size of the section.
+ **/
+const void *object_data(struct aout_object *object, size_t *size)
+{
+    *size = object->header->a_data;
+    return section(object, object->data_offset, object->header->a_data);
+}
+
+/* object_relocations
+ * @brief returns the text or data relocations.
+ * @param object the a.out object.
+ * @param which TEXT_RELOCATIONS or DATA_RELOCATIONS.
+ * @param count set to the number of relocations, 0 if there are none
+ * or the file is truncated.
+ **/
+const struct relocation_info *object_relocations(struct aout_object *object, enum aout_relocations which, unsigned int *count)
+{
+    const struct exec *header = object->header;
+    unsigned int size = which == TEXT_RELOCATIONS ? header->a_trsize : header->a_drsize;
+    unsigned long long offset = which == TEXT_RELOCATIONS ? object->trel_offset : object->drel_offset;
+    const struct relocation_info *relocations = (const struct relocation_info *)section(object, offset, size);
+    *count = relocations != NULL ? size / sizeof(struct relocation_info) : 0;
+    return *count > 0 ? relocations : NULL;
+}
+
+/* symbol_name
+ * @brief returns the name of a symbol or NULL if it has none.
+ * @param object the a.out object.
+ * @param symbol a symbol of the object.
+ *
+ * @details Returns NULL as well if the name is not terminated
+ * within the string table.
+ **/
+const char *symbol_name(struct aout_object *object, const struct nlist *symbol)
+{
+    unsigned long index = (unsigned long)symbol->n_un.n_strx;
+    if (object->strings == NULL || index < sizeof(unsigned int) || index >= object->strings_size) {
+        return NULL;
+    }
+    const char *name = object->strings + index;
+    if (memchr(name, '\0', object->strings_size - index) == NULL) {
+        return NULL;
+    }
+    return name;
+}
+
+/* for_each_symbol
+ * @brief calls a function for every symbol.
+ * @param object the a.out object.
+ * @param callback the function to call, name may be NULL (see symbol_name).
+ * @param data passed to callback.
+ **/
+void for_each_symbol(struct aout_object *object,
+    void (*callback)(const struct nlist *symbol, const char *name, void *data), void *data)
+{
+    for (unsigned int i = 0; i < object->nsymbols; i++) {
+        callback(&object->symbols[i], symbol_name(object, &object->symbols[i]), data);
+    }
+}
+
+/* find_symbol
+ * @brief returns the first defined symbol with the given name or NULL if not found.
+ * @param object the a.out object.
+ * @param name the name of the symbol, e.g. "_main".
+ **/
+const struct nlist *find_symbol(struct aout_object *object, const char *name)
+{
+    for (unsigned int i = 0; i < object->nsymbols; i++) {
+        const struct nlist *symbol = &object->symbols[i];
+        const char *found = symbol_name(object, symbol);
+        if ((symbol->n_type & N_TYPE) != N_UNDF && found != NULL && strcmp(found, name) == 0) {
+            return symbol;
+        }
+    }
+    return NULL;
+}
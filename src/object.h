@@ -0,0 +1,52 @@
+/**
+ * @file object.h
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief read-only, zero-copy view of an a.out file.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "a.out.h"
+
+#ifndef OBJECT_H
+#define OBJECT_H
+
+// an a.out file mapped once, all pointers point into the mapping.
+struct aout_object {
+    void *mapping;              /* start of the mapping, page aligned */
+    size_t mapping_length;
+    const char *file;           /* start of the a.out file in the mapping */
+    size_t size;                /* size of the a.out file */
+    const struct exec *header;
+    unsigned long long text_offset;     /* file offsets of the sections, see N_TXTOFF */
+    unsigned long long data_offset;
+    unsigned long long trel_offset;
+    unsigned long long drel_offset;
+    unsigned long long symbols_offset;
+    unsigned long long strings_offset;
+    const struct nlist *symbols;        /* NULL if stripped */
+    unsigned int nsymbols;
+    const char *strings;        /* string table, NULL if missing */
+    size_t strings_size;
+};
+
+enum aout_relocations {
+    TEXT_RELOCATIONS,
+    DATA_RELOCATIONS
+};
+
+bool open_object(int fd, off_t offset, off_t size, struct aout_object *object);
+void close_object(struct aout_object *object);
+const void *object_text(struct aout_object *object, size_t *size);
+const void *object_data(struct aout_object *object, size_t *size);
+const struct relocation_info *object_relocations(struct aout_object *object, enum aout_relocations which, unsigned int *count);
+const char *symbol_name(struct aout_object *object, const struct nlist *symbol);
+void for_each_symbol(struct aout_object *object,
+    void (*callback)(const struct nlist *symbol, const char *name, void *data), void *data);
+const struct nlist *find_symbol(struct aout_object *object, const char *name);
+
+#endif
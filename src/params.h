@@ -0,0 +1,79 @@
+/**
+ * @file params.h
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief parameter block passed from the controller to the trampoline.
+ */
+
+#include "seccomp.h"
+
+#ifndef PARAMS_H
+#define PARAMS_H
+
+// NOTE: must be kept in sync with the constants in trampoline.asm
+// file descriptor the trampoline reads the parameter block from.
+#define PARAM_FD 1000
+// file descriptor of the image in the a.out host process.
+#define PARAM_IMAGE_FD 1001
+// file descriptors used to hand the userfaultfd of a lazy image to the controller.
+#define PARAM_UFFD_FD 1002
+#define PARAM_READY_FD 1003
+// install the SIGSYS based uselib handler (see _sigsys_handler).
+#define PARAM_FLAG_INPROCESS 0x1
+// raise SIGTRAP before jumping to the entry point (see _start_launch).
+#define PARAM_FLAG_ENTRY_TRAP 0x2
+// map an empty region, the controller fills it on first access (see _map_lazy).
+// Without a userfaultfd, the trampoline reads the sections into it (see _read_lazy).
+#define PARAM_FLAG_LAZY 0x4
+// populate the mappings of the image, bss and libraries (MAP_POPULATE).
+#define PARAM_FLAG_PREFAULT 0x8
+// let the kernel back bss with transparent huge pages (MADV_HUGEPAGE).
+#define PARAM_FLAG_HUGEPAGE 0x10
+// populate and lock the mappings (MAP_LOCKED), if RLIMIT_MEMLOCK allows.
+#define PARAM_FLAG_MLOCK 0x20
+#define PARAM_FILTER_SIZE 64
+#define PARAM_LIBRARIES_SIZE 16384
+#define PARAM_PREMAP_MAX 8
+#define PARAM_PREMAP_PATHS_SIZE 1024
+
+// a library mapped by _start before the entry point, see _map_premapped.
+struct premapped_library {
+    unsigned int path;       /* offset of the path in premap_table.paths */
+    unsigned int name;       /* offset of the file name uselib requests resolve to, see _is_premapped */
+    unsigned int start;      /* same as in trampoline_params */
+    unsigned int length;
+    unsigned int text_length;
+    unsigned int offset;
+    unsigned int bss_start;
+    unsigned int bss_length;
+};
+
+struct premap_table {
+    unsigned int count;
+    struct premapped_library libraries[PARAM_PREMAP_MAX];
+    char paths[PARAM_PREMAP_PATHS_SIZE]; /* NUL terminated paths and names */
+};
+
+// NOTE: must be kept in sync with struc params in trampoline.asm
+struct trampoline_params {
+    unsigned int fd;         /* file descriptor of the (prepared) a.out image */
+    unsigned int start;      /* load address of the text section */
+    unsigned int length;     /* page aligned size of text and data */
+    unsigned int text_length; /* page aligned size of read-only text or 0 if text is writable */
+    unsigned int offset;     /* page aligned offset of the image in fd, e.g. in an archive */
+    unsigned int bss_start;  /* load address of the bss section */
+    unsigned int bss_length; /* page aligned size of bss or 0 if not needed */
+    unsigned int entry;      /* entry point of the a.out executable */
+    unsigned int text_offset; /* lazy images: offset of the text section in fd */
+    unsigned int text_size;  /* lazy images: size of the text section */
+    unsigned int data_start; /* lazy images: offset of the data section in the image */
+    unsigned int data_size;  /* lazy images: size of the data section */
+    unsigned int flags;      /* PARAM_FLAG_* */
+    unsigned int filter_len; /* number of instructions in filter */
+    struct sock_filter filter[PARAM_FILTER_SIZE / sizeof(struct sock_filter)];
+    char libraries[PARAM_LIBRARIES_SIZE]; /* uselib.conf as key\0value\0...\0 */
+    struct premap_table premap; /* libraries mapped at startup, uselib succeeds immediately for them */
+};
+
+#endif
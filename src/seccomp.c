@@ -0,0 +1,69 @@
+/**
+ * @file seccomp.c
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief seccomp-BPF filters used to intercept uselib (and execve).
+ */
+
+#undef __x86_64__ // undefine x86_64 env to make vscode
+				  // use 32-bit header files
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+
+#include "seccomp.h"
+
+/* build_uselib_filter
+ * @brief builds a BPF program that returns action for uselib (and optionally execve).
+ * @param filter buffer of at least USELIB_FILTER_MAX instructions.
+ * @param action the seccomp action, e.g. SECCOMP_RET_TRACE or SECCOMP_RET_TRAP.
+ * @param execve whether execve should be matched as well.
+ *
+ * @details All other system calls are allowed. System calls made with a
+ * different architecture than i386 are not inspected at all.
+ * Returns the number of instructions written to filter.
+ **/
+int build_uselib_filter(struct sock_filter *filter, unsigned int action, bool execve)
+{
+    int n = 0;
+    filter[n++] = (struct sock_filter)BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, arch));
+    filter[n++] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, AUDIT_ARCH_I386, 1, 0);
+    filter[n++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW);
+    filter[n++] = (struct sock_filter)BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, nr));
+    // jump over the optional execve check and the allow to the last instruction.
+    filter[n++] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, SYS_uselib, execve ? 2 : 1, 0);
+    if (execve) {
+        filter[n++] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, SYS_execve, 1, 0);
+    }
+    filter[n++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW);
+    filter[n++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, action);
+    return n;
+}
+
+/* install_uselib_filter
+ * @brief installs a uselib filter in the calling process.
+ * @param action the seccomp action, e.g. SECCOMP_RET_TRACE or SECCOMP_RET_TRAP.
+ * @param execve whether execve should be matched as well.
+ *
+ * @details The filter is inherited by children and kept across execve,
+ * thus it can be installed in the child process before the trampoline
+ * is executed. Only async-signal-safe functions are called, errors are
+ * left to the caller. Returns false with errno set on error.
+ **/
+bool install_uselib_filter(unsigned int action, bool execve)
+{
+    struct sock_filter filter[USELIB_FILTER_MAX];
+    struct sock_fprog program = {
+        .len = build_uselib_filter(filter, action, execve),
+        .filter = filter,
+    };
+
+    // required to install a filter without CAP_SYS_ADMIN.
+    return prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) == 0
+        && prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &program, 0, 0) == 0;
+}
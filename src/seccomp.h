@@ -0,0 +1,25 @@
+/**
+ * @file seccomp.h
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief seccomp-BPF filters used to intercept uselib (and execve).
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <linux/filter.h>
+#include <linux/seccomp.h>
+#include <linux/audit.h>
+
+#ifndef SECCOMP_H
+#define SECCOMP_H
+
+// maximum number of BPF instructions produced by build_uselib_filter.
+#define USELIB_FILTER_MAX 8
+
+int build_uselib_filter(struct sock_filter *filter, unsigned int action, bool execve);
+bool install_uselib_filter(unsigned int action, bool execve);
+
+#endif
@@ -0,0 +1,88 @@
+/**
+ * @file api.c
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief tests of the option checks and error reporting of librunaout.
+ *
+ * @details No program is started, the trampoline is an empty file.
+ */
+
+#undef __x86_64__ // undefine x86_64 env to make vscode
+				  // use 32-bit header files
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <linux/limits.h>
+
+#include "librunaout.h"
+#include "test.h"
+
+/* test_create
+ * @brief invalid options and a missing trampoline.
+ **/
+static void test_create(const char *trampoline, const char *uselib_conf)
+{
+    struct runaout_options options = { .trampoline = trampoline, .uselib_conf = uselib_conf, .log = stdout };
+    runaout_t context = runaout_create(&options);
+    CHECK(context != NULL);
+    if (context != NULL) {
+        struct runaout_stats stats;
+        runaout_stats(context, &stats);
+        CHECK(stats.launches == 0 && stats.uselibs == 0);
+        runaout_destroy(context);
+    }
+
+    // seccomp does not stop for the syscall that triggers the detach.
+    options.use_seccomp = true;
+    options.detach_trigger = DETACH_SYSCALL;
+    errno = 0;
+    CHECK(runaout_create(&options) == NULL && errno == EINVAL);
+
+    options.use_seccomp = false;
+    options.detach_trigger = DETACH_NEVER;
+    char missing[PATH_MAX];
+    options.trampoline = temporary_path("missing-trampoline", missing);
+    errno = 0;
+    CHECK(runaout_create(&options) == NULL && errno == ENOENT);
+}
+
+/* test_launch
+ * @brief launches which fail before the trampoline is started.
+ **/
+static void test_launch(const char *trampoline, const char *uselib_conf)
+{
+    struct runaout_options options = { .trampoline = trampoline, .uselib_conf = uselib_conf, .log = stdout };
+    runaout_t context = runaout_create(&options);
+    CHECK(context != NULL);
+    if (context == NULL) {
+        return;
+    }
+
+    char path[PATH_MAX];
+    char *missing[] = { temporary_path("missing.out", path), NULL };
+    errno = 0;
+    CHECK(runaout_launch(context, missing) == -1 && errno == ENOENT);
+
+    char *invalid[] = { write_file("invalid.out", "#!/bin/sh\n", 10, path), NULL };
+    errno = 0;
+    CHECK(runaout_launch(context, invalid) == -1 && errno == ENOEXEC);
+
+    struct runaout_stats stats;
+    runaout_stats(context, &stats);
+    CHECK(stats.launches == 0);
+    runaout_destroy(context);
+}
+
+int main(void)
+{
+    start_tests();
+    char trampoline[PATH_MAX], uselib_conf[PATH_MAX];
+    write_file("trampoline", "", 0, trampoline);
+    write_file("uselib.conf", "", 0, uselib_conf);
+
+    test_create(trampoline, uselib_conf);
+    test_launch(trampoline, uselib_conf);
+    return finish_tests("api");
+}
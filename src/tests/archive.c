@@ -0,0 +1,165 @@
+/**
+ * @file archive.c
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief tests of ar and tar members.
+ *
+ * @details The archives are written by hand, the corrupt ones must fail
+ * with ENOEXEC instead of reading past the end of the archive.
+ */
+
+#undef __x86_64__ // undefine x86_64 env to make vscode
+				  // use 32-bit header files
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/limits.h>
+
+#include "archive.h"
+#include "test.h"
+
+/* check_member
+ * @brief checks that an archive member can be opened and has the expected contents.
+ **/
+static void check_member(const char *archive, const char *name, const char *expected)
+{
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s(%s)", archive, name);
+    struct member member;
+    bool found = open_member(path, O_RDONLY | O_CLOEXEC, &member);
+    CHECK(found);
+    if (found) {
+        CHECK(read_member(&member, expected, strlen(expected)));
+        close(member.fd);
+    }
+}
+
+// the fields of an ar member header, see archive.c.
+struct ar_layout {
+    char name[16];
+    char date[12];
+    char uid[6];
+    char gid[6];
+    char mode[8];
+    char size[10];
+    char fmag[2];
+};
+
+/* ar_member
+ * @brief appends an ar member to buffer, returns the length of header, data and padding.
+ **/
+static int ar_member(char *buffer, const char *name, const void *data, long size)
+{
+    char header[61];
+    snprintf(header, sizeof(header), "%-16s%-12s%-6s%-6s%-8s%-10ld`\n", name, "0", "0", "0", "644", size);
+    memcpy(buffer, header, 60);
+    memcpy(buffer + 60, data, size);
+    if (size & 1) {
+        buffer[60 + size++] = '\n';
+    }
+    return 60 + size;
+}
+
+/* test_ar
+ * @brief GNU short and long names, BSD long names and corrupt sizes.
+ **/
+static void test_ar(void)
+{
+    char archive[4096];
+    int length = 0;
+    length += sprintf(archive, "!<arch>\n");
+    const char *long_names = "a_rather_long_member_name.o/\n";
+    length += ar_member(archive + length, "//", long_names, strlen(long_names));
+    length += ar_member(archive + length, "short.o/", "short", 5);
+    length += ar_member(archive + length, "/0", "long", 4);
+    // the name is padded with NUL and precedes the data.
+    length += ar_member(archive + length, "#1/12", "bsd_named.o\0bsd", 12 + 3);
+
+    char path[PATH_MAX];
+    write_file("test.a", archive, length, path);
+    check_member(path, "short.o", "short");
+    check_member(path, "a_rather_long_member_name.o", "long");
+    check_member(path, "bsd_named.o", "bsd");
+
+    char name[PATH_MAX + 16];
+    snprintf(name, sizeof(name), "%s(missing.o)", path);
+    CHECK(open_error(name) == ENOENT);
+
+    // the size of the first member runs past the end of the archive.
+    length = sprintf(archive, "!<arch>\n");
+    length += ar_member(archive + length, "huge.o/", "data", 4);
+    memcpy(archive + strlen("!<arch>\n") + offsetof(struct ar_layout, size), "999999    ", 10);
+    write_file("corrupt.a", archive, length, path);
+    snprintf(name, sizeof(name), "%s(huge.o)", path);
+    CHECK(open_error(name) == ENOEXEC);
+
+    // BSD name longer than the member.
+    length = sprintf(archive, "!<arch>\n");
+    length += ar_member(archive + length, "#1/64", "name", 4);
+    write_file("corrupt-bsd.a", archive, length, path);
+    snprintf(name, sizeof(name), "%s(name)", path);
+    CHECK(open_error(name) == ENOEXEC);
+}
+
+/* tar_member
+ * @brief appends a tar member to buffer, returns the length of header and data.
+ **/
+static int tar_member(char *buffer, const char *name, char typeflag, const char *data, long size)
+{
+    char header[512];
+    memset(header, 0, sizeof(header));
+    snprintf(header, 100, "%s", name);
+    snprintf(header + 124, 12, "%011lo", size);
+    header[156] = typeflag;
+    memcpy(header + 257, "ustar", 6);
+    memcpy(header + 263, "00", 2);
+    memcpy(buffer, header, sizeof(header));
+    memset(buffer + 512, 0, (size + 511) / 512 * 512);
+    memcpy(buffer + 512, data, strlen(data));
+    return 512 + (size + 511) / 512 * 512;
+}
+
+/* test_tar
+ * @brief plain and GNU long names and corrupt sizes.
+ **/
+static void test_tar(void)
+{
+    static char archive[8 * 512];
+    memset(archive, 0, sizeof(archive));
+    int length = 0;
+    length += tar_member(archive + length, "./lib/plain", '0', "plain", 5);
+    const char *long_name = "lib/a_member_name_which_is_longer_than_the_one_hundred_bytes_of_the_name_field_of_the_tar_header.so";
+    length += tar_member(archive + length, "././@LongLink", 'L', long_name, strlen(long_name) + 1);
+    length += tar_member(archive + length, "replaced", '0', "long", 4);
+    length += 2 * 512;
+
+    char path[PATH_MAX];
+    write_file("test.tar", archive, length, path);
+    check_member(path, "lib/plain", "plain");
+    check_member(path, "./lib/plain", "plain");
+    check_member(path, long_name, "long");
+
+    char name[PATH_MAX + 16];
+    snprintf(name, sizeof(name), "%s(replaced)", path);
+    CHECK(open_error(name) == ENOENT);
+
+    memset(archive, 0, sizeof(archive));
+    length = tar_member(archive, "huge", '0', "data", 4);
+    snprintf(archive + 124, 12, "%011o", 0777777);
+    length += 2 * 512;
+    write_file("corrupt.tar", archive, length, path);
+    snprintf(name, sizeof(name), "%s(huge)", path);
+    CHECK(open_error(name) == ENOEXEC);
+}
+
+int main(void)
+{
+    start_tests();
+    test_ar();
+    test_tar();
+    return finish_tests("archive");
+}
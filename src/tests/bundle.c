@@ -0,0 +1,76 @@
+/**
+ * @file bundle.c
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief tests of bundles.
+ */
+
+#undef __x86_64__ // undefine x86_64 env to make vscode
+				  // use 32-bit header files
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/limits.h>
+
+#include "bundle.h"
+#include "test.h"
+
+/* test_bundle
+ * @brief stored and compressed members, missing members and a corrupt index.
+ **/
+static void test_bundle(void)
+{
+    struct test_aout aout;
+    make_test_aout(&aout);
+    static char pages[4 * 4096];
+    memset(pages, 'x', sizeof(pages));
+    pages[sizeof(pages) - 1] = '\0';
+
+    char object[PATH_MAX], text[PATH_MAX], bundle[PATH_MAX];
+    write_file("test.o", &aout, sizeof(aout), object);
+    write_file("pages.txt", pages, strlen(pages), text);
+    char *files[] = { object, text };
+    temporary_path("test.bundle", bundle);
+    CHECK(create_bundle(bundle, files, 2));
+
+    int fd = open(bundle, O_RDONLY | O_CLOEXEC);
+    CHECK(is_bundle(fd));
+    close(fd);
+    fd = open(object, O_RDONLY | O_CLOEXEC);
+    CHECK(!is_bundle(fd));
+    close(fd);
+
+    char name[PATH_MAX + 16];
+    struct member member;
+    snprintf(name, sizeof(name), "%s(test.o)", bundle);
+    CHECK(open_member(name, O_RDONLY | O_CLOEXEC, &member));
+    CHECK(member.offset % 4096 == 0 && read_member(&member, &aout, sizeof(aout)));
+    close(member.fd);
+
+    snprintf(name, sizeof(name), "%s(pages.txt)", bundle);
+    CHECK(open_member(name, O_RDONLY | O_CLOEXEC, &member));
+    CHECK(member.offset == 0 && strncmp(member.path, "/proc/", 6) == 0);
+    CHECK(read_member(&member, pages, strlen(pages)));
+    close(member.fd);
+
+    snprintf(name, sizeof(name), "%s(missing)", bundle);
+    CHECK(open_error(name) == ENOENT);
+
+    // a member count beyond the end of the file.
+    struct bundle_header header = { .count = 1000 };
+    memcpy(header.magic, BUNDLE_MAGIC, sizeof(header.magic));
+    write_file("corrupt.bundle", &header, sizeof(header), bundle);
+    snprintf(name, sizeof(name), "%s(test.o)", bundle);
+    CHECK(open_error(name) == ENOEXEC);
+}
+
+int main(void)
+{
+    start_tests();
+    test_bundle();
+    return finish_tests("bundle");
+}
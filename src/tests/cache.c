@@ -0,0 +1,198 @@
+/**
+ * @file cache.c
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief tests of the image cache: publishing, hits, stale keys, corrupt
+ * entries and eviction.
+ */
+
+#define _GNU_SOURCE
+
+#undef __x86_64__ // undefine x86_64 env to make vscode
+				  // use 32-bit header files
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <linux/limits.h>
+
+#include "cache.h"
+#include "test.h"
+
+/* lookup
+ * @brief looks up the image of an a.out file and checks its contents.
+ * @param cache the image cache.
+ * @param path the path of a struct test_aout file.
+ * @param expected the contents of the file.
+ *
+ * Returns false if the lookup failed.
+ **/
+static bool lookup(struct image_cache *cache, const char *path, struct test_aout *expected)
+{
+    int source = open(path, O_RDONLY | O_CLOEXEC);
+    struct exec header = expected->header;
+    struct image image;
+    bool found = cached_image(cache, source, &header, N_TXTOFF(header), 0, &image);
+    close(source);
+    if (!found) {
+        return false;
+    }
+
+    // OMAGIC: text at offset 0 of the image, data right after it.
+    char text[sizeof(expected->text) + sizeof(expected->data)];
+    CHECK(image.start == (header.a_entry & 0xfffff000) && image.text_length == 0);
+    CHECK(pread(image.fd, text, sizeof(text), 0) == (ssize_t)sizeof(text)
+        && memcmp(text, expected->text, sizeof(expected->text)) == 0
+        && memcmp(text + sizeof(expected->text), expected->data, sizeof(expected->data)) == 0);
+    close(image.fd);
+    return true;
+}
+
+/* find_entry
+ * @brief returns the path of the only image entry of the cache directory or NULL.
+ **/
+static char *find_entry(const char *directory, char *buffer)
+{
+    DIR *dir = opendir(directory);
+    struct dirent *dirent;
+    int count = 0;
+    while (dir != NULL && (dirent = readdir(dir)) != NULL) {
+        size_t length = strlen(dirent->d_name);
+        if (length > 4 && strcmp(dirent->d_name + length - 4, ".img") == 0) {
+            snprintf(buffer, PATH_MAX, "%s/%s", directory, dirent->d_name);
+            count++;
+        }
+    }
+    if (dir != NULL) {
+        closedir(dir);
+    }
+    return count == 1 ? buffer : NULL;
+}
+
+/* test_hits
+ * @brief a miss publishes an entry, hits are found for the file and its copies.
+ **/
+static void test_hits(const char *directory)
+{
+    struct image_cache cache;
+    CHECK(open_image_cache(&cache, directory, 0));
+
+    struct test_aout aout;
+    make_test_aout(&aout);
+    char path[PATH_MAX], copy[PATH_MAX];
+    write_file("hits.out", &aout, sizeof(aout), path);
+    write_file("hits-copy.out", &aout, sizeof(aout), copy);
+
+    CHECK(lookup(&cache, path, &aout));
+    CHECK(cache.misses == 1 && cache.hits == 0);
+    CHECK(lookup(&cache, path, &aout));
+    CHECK(lookup(&cache, copy, &aout));
+    CHECK(cache.misses == 1 && cache.hits == 2);
+
+    // a rewritten file gets a new key and never hits the old entry.
+    memcpy(aout.text, "rewritten text.", 16);
+    write_file("hits.out", &aout, sizeof(aout), path);
+    CHECK(lookup(&cache, path, &aout));
+    CHECK(cache.misses == 2 && cache.hits == 2);
+    close_image_cache(&cache);
+}
+
+/* test_corruption
+ * @brief a corrupt entry of the right size is discarded and reconverted.
+ **/
+static void test_corruption(const char *directory)
+{
+    struct image_cache cache;
+    CHECK(open_image_cache(&cache, directory, 0));
+
+    struct test_aout aout;
+    make_test_aout(&aout);
+    char path[PATH_MAX], entry[PATH_MAX];
+    write_file("corrupt.out", &aout, sizeof(aout), path);
+    CHECK(lookup(&cache, path, &aout));
+    CHECK(find_entry(directory, entry) != NULL);
+
+    // overwrite a byte of the text section in place, the size stays the same.
+    chmod(entry, 0644);
+    int fd = open(entry, O_WRONLY | O_CLOEXEC);
+    CHECK(fd != -1 && pwrite(fd, "X", 1, 0) == 1);
+    close(fd);
+
+    CHECK(lookup(&cache, path, &aout));
+    CHECK(cache.misses == 2 && cache.hits == 0);
+    CHECK(lookup(&cache, path, &aout));
+    CHECK(cache.misses == 2 && cache.hits == 1);
+
+    // a truncated entry is discarded as well.
+    CHECK(find_entry(directory, entry) != NULL);
+    chmod(entry, 0644);
+    CHECK(truncate(entry, 4096) == 0);
+    CHECK(lookup(&cache, path, &aout));
+    CHECK(cache.misses == 3 && cache.hits == 1);
+    close_image_cache(&cache);
+}
+
+/* test_eviction
+ * @brief the least recently used files are removed, the new entry is kept.
+ **/
+static void test_eviction(const char *directory)
+{
+    struct image_cache cache;
+    CHECK(open_image_cache(&cache, directory, 1));
+
+    struct test_aout aout;
+    make_test_aout(&aout);
+    char first[PATH_MAX], second[PATH_MAX], entry[PATH_MAX];
+    write_file("first.out", &aout, sizeof(aout), first);
+    CHECK(lookup(&cache, first, &aout));
+    memcpy(aout.data, "other..", 8);
+    write_file("second.out", &aout, sizeof(aout), second);
+    CHECK(lookup(&cache, second, &aout));
+    CHECK(cache.evictions > 0);
+    CHECK(find_entry(directory, entry) != NULL);
+    CHECK(lookup(&cache, second, &aout));
+    CHECK(cache.hits == 1);
+    close_image_cache(&cache);
+}
+
+/* test_unlinked_source
+ * @brief files without a stable identity, e.g. memfds, are not cached.
+ **/
+static void test_unlinked_source(const char *directory)
+{
+    struct image_cache cache;
+    CHECK(open_image_cache(&cache, directory, 0));
+
+    struct test_aout aout;
+    make_test_aout(&aout);
+    int source = memfd_create("aout", MFD_CLOEXEC);
+    CHECK(source != -1 && write(source, &aout, sizeof(aout)) == (ssize_t)sizeof(aout));
+    struct image image;
+    CHECK(!cached_image(&cache, source, &aout.header, N_TXTOFF(aout.header), 0, &image));
+    CHECK(cache.misses == 0 && cache.hits == 0);
+    close(source);
+
+    struct image_cache disabled = { .dir = -1 };
+    char path[PATH_MAX];
+    source = open(write_file("disabled.out", &aout, sizeof(aout), path), O_RDONLY | O_CLOEXEC);
+    CHECK(!cached_image(&disabled, source, &aout.header, N_TXTOFF(aout.header), 0, &image));
+    close(source);
+    close_image_cache(&cache);
+}
+
+int main(void)
+{
+    start_tests();
+    char directory[PATH_MAX];
+    test_hits(temporary_path("hits", directory));
+    test_corruption(temporary_path("corruption", directory));
+    test_eviction(temporary_path("eviction", directory));
+    test_unlinked_source(temporary_path("unlinked", directory));
+    return finish_tests("cache");
+}
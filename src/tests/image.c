@@ -0,0 +1,136 @@
+/**
+ * @file image.c
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief tests of the image layout: describe_image, qmagic_image,
+ * lazy_image and the conversion by prepare_image.
+ */
+
+#undef __x86_64__ // undefine x86_64 env to make vscode
+				  // use 32-bit header files
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/limits.h>
+
+#include "image.h"
+#include "test.h"
+
+#define TEXT_SIZE 0x1800
+#define DATA_SIZE 0x300
+
+/* make_header
+ * @brief returns an a.out header with the given magic number and sizes.
+ **/
+static struct exec make_header(unsigned int magic, unsigned int text, unsigned int data, unsigned int bss)
+{
+    struct exec header;
+    memset(&header, 0, sizeof(header));
+    header.a_info = magic | (M_386 << 16);
+    header.a_text = text;
+    header.a_data = data;
+    header.a_bss = bss;
+    header.a_entry = 0x1020;
+    return header;
+}
+
+/* test_describe
+ * @brief read-only text, the page shared by text and data and bss.
+ **/
+static void test_describe(void)
+{
+    struct image image;
+    struct exec header = make_header(MAGIC_ZMAGIC, 0x2000, 0x800, 0x1900);
+    describe_image(3, &header, 0x2800, &image);
+    CHECK(image.fd == 3 && image.start == 0x1000 && image.entry == 0x1020 && !image.lazy);
+    CHECK(image.text_length == 0x2000 && image.length == 0x3000);
+    CHECK(image.bss_start == 0x4000 && image.bss_length == 0x2000);
+
+    // bss within the last page of data needs no mapping of its own.
+    header.a_bss = 0x100;
+    describe_image(3, &header, 0x2800, &image);
+    CHECK(image.bss_start == 0x4000 && image.bss_length == 0);
+
+    // the page text shares with data stays writable.
+    header = make_header(MAGIC_ZMAGIC, 0x1800, 0x400, 0);
+    describe_image(3, &header, 0x1c00, &image);
+    CHECK(image.text_length == 0x1000 && image.length == 0x2000);
+
+    // OMAGIC text is writable.
+    header = make_header(MAGIC_OMAGIC, 0x2000, 0x800, 0);
+    describe_image(3, &header, 0x2800, &image);
+    CHECK(image.text_length == 0 && image.length == 0x3000);
+
+    header = make_header(MAGIC_QMAGIC, 0x1f00, 0x300, 0x1000);
+    qmagic_image(3, &header, &image);
+    CHECK(image.text_length == 0x2000 && image.length == 0x3000);
+    CHECK(image.bss_start == 0x4000 && image.bss_length == 0x1000);
+}
+
+/* test_lazy
+ * @brief lazy images have the layout of write_image and writable text.
+ **/
+static void test_lazy(void)
+{
+    struct image image;
+    struct exec header = make_header(MAGIC_ZMAGIC, TEXT_SIZE, DATA_SIZE, 0x2000);
+    lazy_image(3, &header, 1024, 0, &image);
+    CHECK(image.lazy && image.fd == 3 && image.start == 0x1000);
+    CHECK(image.text_length == 0 && image.text_offset == 1024);
+    CHECK(image.data_start == TEXT_SIZE && image.text_size == TEXT_SIZE && image.data_size == DATA_SIZE);
+    CHECK(image.length == 0x2000 && image.bss_start == 0x3000 && image.bss_length == 0x2000);
+
+    // an aligned data section leaves a gap after text.
+    lazy_image(3, &header, 1024, 0x2000, &image);
+    CHECK(image.data_start == 0x2000 && image.length == 0x3000);
+    lazy_image(3, &header, 1024, 0x1000, &image);
+    CHECK(image.data_start == TEXT_SIZE);
+}
+
+/* test_conversion
+ * @brief reading the sections as described by lazy_image (see _read_lazy)
+ * gives the same bytes as the converted image.
+ **/
+static void test_conversion(void)
+{
+    static char file[sizeof(struct exec) + TEXT_SIZE + DATA_SIZE];
+    struct exec header = make_header(MAGIC_OMAGIC, TEXT_SIZE, DATA_SIZE, 0x100);
+    memcpy(file, &header, sizeof(header));
+    for (unsigned int i = sizeof(header); i < sizeof(file); i++) {
+        file[i] = (char)(i * 7 + 1);
+    }
+    char path[PATH_MAX];
+    int source = open(write_file("conversion.out", file, sizeof(file), path), O_RDONLY | O_CLOEXEC);
+    CHECK(source != -1);
+
+    for (unsigned int data_offset = 0; data_offset <= 0x2000; data_offset += 0x2000) {
+        struct image lazy, converted;
+        lazy_image(source, &header, sizeof(header), data_offset, &lazy);
+        CHECK(prepare_image(source, &header, sizeof(header), data_offset, &converted));
+        CHECK(converted.start == lazy.start && converted.length == lazy.length
+            && converted.bss_start == lazy.bss_start && converted.bss_length == lazy.bss_length);
+
+        static char expected[0x3000], actual[0x3000];
+        unsigned int size = lazy.data_start + lazy.data_size;
+        memset(expected, 0, sizeof(expected));
+        CHECK(pread(source, expected, lazy.text_size, lazy.text_offset) == (ssize_t)lazy.text_size);
+        CHECK(pread(source, expected + lazy.data_start, lazy.data_size, lazy.text_offset + lazy.text_size)
+            == (ssize_t)lazy.data_size);
+        CHECK(pread(converted.fd, actual, sizeof(actual), 0) == (ssize_t)size);
+        CHECK(memcmp(expected, actual, size) == 0);
+        close(converted.fd);
+    }
+    close(source);
+}
+
+int main(void)
+{
+    start_tests();
+    test_describe();
+    test_lazy();
+    test_conversion();
+    return finish_tests("image");
+}
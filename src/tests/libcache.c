@@ -0,0 +1,151 @@
+/**
+ * @file libcache.c
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief tests of the library cache: failed lookups and invalidation.
+ */
+
+#undef __x86_64__ // undefine x86_64 env to make vscode
+				  // use 32-bit header files
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <linux/limits.h>
+
+#include "libcache.h"
+#include "test.h"
+
+/* test_negative
+ * @brief a missing library is cached until it is created.
+ **/
+static void test_negative(void)
+{
+    struct library_cache cache;
+    memset(&cache, 0, sizeof(cache));
+    char path[PATH_MAX];
+    temporary_path("libmissing.so.4", path);
+
+    struct library *library = add_library(&cache, "libmissing.so.4", path);
+    CHECK(library != NULL && library->error == -ENOENT && !library->exists && library->fd == -1);
+    CHECK(find_library(&cache, "libmissing.so.4") == library);
+    CHECK(find_library(&cache, "/lib/libmissing.so.4") == NULL);
+    CHECK(cache.hits == 1 && cache.misses == 1);
+
+    write_file("libmissing.so.4", "library", 7, path);
+    CHECK(find_library(&cache, "libmissing.so.4") == NULL);
+    CHECK(find_library(&cache, "libmissing.so.4") == NULL);
+    CHECK(cache.hits == 1 && cache.misses == 3);
+    free_library_cache(&cache);
+}
+
+/* test_transient
+ * @brief failed lookups other than ENOENT are retried.
+ **/
+static void test_transient(void)
+{
+    struct library_cache cache;
+    memset(&cache, 0, sizeof(cache));
+    char path[PATH_MAX];
+    temporary_path("libdenied.so.4", path);
+
+    int errors[] = { -EACCES, -ENOMEM, -ENOEXEC };
+    for (unsigned int i = 0; i < sizeof(errors) / sizeof(errors[0]); i++) {
+        struct library *library = add_library(&cache, "libdenied.so.4", path);
+        CHECK(library != NULL);
+        if (library != NULL) {
+            library->error = errors[i];
+        }
+        CHECK(find_library(&cache, "libdenied.so.4") == NULL);
+    }
+    CHECK(cache.hits == 0);
+    free_library_cache(&cache);
+}
+
+/* test_changed
+ * @brief a library is looked up again once its file or archive changes.
+ **/
+static void test_changed(void)
+{
+    struct library_cache cache;
+    memset(&cache, 0, sizeof(cache));
+    char path[PATH_MAX], other[PATH_MAX], member[PATH_MAX + 16];
+    write_file("libfound.so.4", "library", 7, path);
+
+    struct library *library = add_library(&cache, "libfound.so.4", path);
+    CHECK(library != NULL && library->exists);
+    if (library != NULL) {
+        library->error = 0;
+    }
+    CHECK(find_library(&cache, "libfound.so.4") == library);
+
+    // a new modification time.
+    struct timespec times[2] = { { 0, UTIME_OMIT }, { 1000000, 0 } };
+    CHECK(utimensat(AT_FDCWD, path, times, 0) == 0);
+    CHECK(find_library(&cache, "libfound.so.4") == NULL);
+
+    // the same modification time, but a new file.
+    library = add_library(&cache, "libfound.so.4", path);
+    CHECK(library != NULL);
+    if (library != NULL) {
+        library->error = 0;
+    }
+    write_file("libfound.new", "library", 7, other);
+    CHECK(utimensat(AT_FDCWD, other, times, 0) == 0);
+    CHECK(rename(other, path) == 0);
+    CHECK(find_library(&cache, "libfound.so.4") == NULL);
+
+    // members are checked by the identity of their archive.
+    snprintf(member, sizeof(member), "%s(libc.so.4)", path);
+    library = add_library(&cache, "libc.so.4", member);
+    CHECK(library != NULL && library->exists);
+    if (library != NULL) {
+        library->error = 0;
+    }
+    CHECK(find_library(&cache, "libc.so.4") == library);
+    CHECK(unlink(path) == 0);
+    CHECK(find_library(&cache, "libc.so.4") == NULL);
+    free_library_cache(&cache);
+}
+
+/* test_many
+ * @brief entries sharing a bucket are found and invalidated independently.
+ **/
+static void test_many(void)
+{
+    struct library_cache cache;
+    memset(&cache, 0, sizeof(cache));
+    char path[PATH_MAX], request[32];
+    temporary_path("libnone.so.4", path);
+    for (int i = 0; i < 4 * LIBRARY_BUCKETS; i++) {
+        snprintf(request, sizeof(request), "lib%d.so.4", i);
+        struct library *library = add_library(&cache, request, path);
+        CHECK(library != NULL);
+        if (library != NULL && i % 2 == 1) {
+            library->error = -EACCES;
+        }
+    }
+    int found = 0;
+    for (int i = 0; i < 4 * LIBRARY_BUCKETS; i++) {
+        snprintf(request, sizeof(request), "lib%d.so.4", i);
+        struct library *library = find_library(&cache, request);
+        found += library != NULL && strcmp(library->request, request) == 0;
+    }
+    CHECK(found == 2 * LIBRARY_BUCKETS);
+    CHECK(cache.hits == 2 * LIBRARY_BUCKETS && cache.misses == 2 * LIBRARY_BUCKETS);
+    free_library_cache(&cache);
+}
+
+int main(void)
+{
+    start_tests();
+    test_negative();
+    test_transient();
+    test_changed();
+    test_many();
+    return finish_tests("libcache");
+}
@@ -0,0 +1,75 @@
+/**
+ * @file object.c
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief tests of the a.out object model.
+ */
+
+#undef __x86_64__ // undefine x86_64 env to make vscode
+				  // use 32-bit header files
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/limits.h>
+
+#include "object.h"
+#include "test.h"
+
+/* test_object
+ * @brief sections, symbol lookup and truncated files.
+ **/
+static void test_object(void)
+{
+    struct test_aout aout;
+    make_test_aout(&aout);
+    char path[PATH_MAX];
+    write_file("test.o", &aout, sizeof(aout), path);
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct aout_object object;
+    CHECK(open_object(fd, 0, sizeof(aout), &object));
+    size_t size;
+    const char *text = object_text(&object, &size);
+    CHECK(text != NULL && size == sizeof(aout.text) && memcmp(text, aout.text, size) == 0);
+    const char *data = object_data(&object, &size);
+    CHECK(data != NULL && size == sizeof(aout.data) && memcmp(data, aout.data, size) == 0);
+    CHECK(object.nsymbols == 2);
+    const struct nlist *symbol = find_symbol(&object, "_main");
+    CHECK(symbol != NULL && symbol->n_value == 0x1234);
+    CHECK(find_symbol(&object, "_undef") == NULL);
+    CHECK(find_symbol(&object, "_missing") == NULL);
+    unsigned int count;
+    CHECK(object_relocations(&object, TEXT_RELOCATIONS, &count) == NULL && count == 0);
+    CHECK(symbol_name(&object, &object.symbols[1]) != NULL && strcmp(symbol_name(&object, &object.symbols[1]), "_undef") == 0);
+    close_object(&object);
+
+    // without the string table, the symbols have no names.
+    CHECK(open_object(fd, 0, offsetof(struct test_aout, strings_size), &object));
+    CHECK(object.symbols != NULL && object.strings == NULL);
+    CHECK(find_symbol(&object, "_main") == NULL);
+    close_object(&object);
+
+    // the symbol table is missing, the sections are still there.
+    CHECK(open_object(fd, 0, offsetof(struct test_aout, symbols) + 1, &object));
+    CHECK(object.symbols == NULL && object.nsymbols == 0);
+    CHECK(object_data(&object, &size) != NULL);
+    close_object(&object);
+
+    // the header must be complete and within the file.
+    errno = 0;
+    CHECK(!open_object(fd, 0, sizeof(struct exec) - 1, &object) && errno == ENOEXEC);
+    errno = 0;
+    CHECK(!open_object(fd, 1, sizeof(aout), &object) && errno == ENOEXEC);
+    close(fd);
+}
+
+int main(void)
+{
+    start_tests();
+    test_object();
+    return finish_tests("object");
+}
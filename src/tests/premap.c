@@ -0,0 +1,132 @@
+/**
+ * @file premap.c
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief tests of premapped libraries in-process: a converted (ZMAGIC)
+ * library is mapped at startup and its uselib call succeeds.
+ *
+ * @details Runs gforth with the libraries in ../lib, the test passes
+ * without running anything if they or the trampoline are missing.
+ */
+
+#undef __x86_64__ // undefine x86_64 env to make vscode
+				  // use 32-bit header files
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <linux/limits.h>
+
+#include "librunaout.h"
+#include "test.h"
+
+#define TRAMPOLINE "./trampoline"
+#define GFORTH "../gforth/gforth-0.3.0"
+#define GFORTH_IMAGE "../gforth/gforth-0.3.0.fi"
+#define LD_SO "../lib/ld.so"
+#define LIBC "../lib/libc.so.4.7.2"
+#define LIBM "../lib/libm.so.4.6.27"
+
+/* convert_to_zmagic
+ * @brief writes a ZMAGIC copy of a QMAGIC library, which uselib only loads converted.
+ * @param source the QMAGIC library.
+ * @param buffer receives the path of the copy.
+ *
+ * @details The QMAGIC header is part of the text section, thus the copy is
+ * the file as is, behind a header block of 1024 bytes (see N_TXTOFF).
+ **/
+static char *convert_to_zmagic(const char *source, char *buffer)
+{
+    static char file[1024 + 512 * 1024];
+    int fd = open(source, O_RDONLY | O_CLOEXEC);
+    ssize_t size = fd != -1 ? read(fd, file + 1024, sizeof(file) - 1024) : -1;
+    close(fd);
+    CHECK(size >= (ssize_t)sizeof(struct exec) && size < (ssize_t)sizeof(file) - 1024);
+    if (size < (ssize_t)sizeof(struct exec)) {
+        return NULL;
+    }
+
+    struct exec header;
+    memcpy(&header, file + 1024, sizeof(header));
+    CHECK(N_MAGIC(header) == MAGIC_QMAGIC);
+    header.a_info = MAGIC_ZMAGIC | (M_386 << 16);
+    memset(file, 0, 1024);
+    memcpy(file, &header, sizeof(header));
+    return write_file("libm.so.4", file, 1024 + size, buffer);
+}
+
+/* run_gforth
+ * @brief runs gforth in-process until it reads "bye" and returns its exit code.
+ * @param uselib_conf maps the libraries of gforth.
+ * @param premap whether the libraries are mapped at startup.
+ * @param premapped set to the number of libraries mapped at startup.
+ **/
+static int run_gforth(const char *uselib_conf, bool premap, unsigned long *premapped)
+{
+    char index[PATH_MAX];
+    struct runaout_options options = {
+        .trampoline = TRAMPOLINE,
+        .uselib_conf = uselib_conf,
+        .uselib_index = temporary_path("uselib.idx", index),
+        .in_process = true,
+        .premap_libraries = premap
+    };
+    runaout_t context = runaout_create(&options);
+    CHECK(context != NULL);
+    if (context == NULL) {
+        return -1;
+    }
+
+    // gforth reads its commands from stdin.
+    char input[PATH_MAX];
+    int saved = dup(STDIN_FILENO);
+    int fd = open(write_file("input", "bye\n", 4, input), O_RDONLY | O_CLOEXEC);
+    dup2(fd, STDIN_FILENO);
+    close(fd);
+    char *argv[] = { GFORTH, "-i", GFORTH_IMAGE, NULL };
+    pid_t pid = runaout_launch(context, argv);
+    dup2(saved, STDIN_FILENO);
+    close(saved);
+
+    int exit_code = -1;
+    CHECK(pid != -1 && runaout_wait(context, pid, &exit_code) == 0);
+    struct runaout_stats stats;
+    runaout_stats(context, &stats);
+    *premapped = stats.premapped;
+    runaout_destroy(context);
+    return exit_code;
+}
+
+int main(void)
+{
+    start_tests();
+    const char *required[] = { TRAMPOLINE, GFORTH, GFORTH_IMAGE, LD_SO, LIBC, LIBM };
+    for (unsigned int i = 0; i < sizeof(required) / sizeof(required[0]); i++) {
+        if (access(required[i], R_OK) != 0) {
+            printf("premap: %s not found, skipped.\n", required[i]);
+            return finish_tests("premap");
+        }
+    }
+
+    char ld_so[PATH_MAX], libc[PATH_MAX], libm[PATH_MAX], uselib_conf[PATH_MAX];
+    static char conf[4 * PATH_MAX];
+    if (realpath(LD_SO, ld_so) == NULL || realpath(LIBC, libc) == NULL || convert_to_zmagic(LIBM, libm) == NULL) {
+        CHECK(false);
+        return finish_tests("premap");
+    }
+    snprintf(conf, sizeof(conf), "ld.so:%s\nlibc.so.4:%s\nlibm.so.4:%s\n", ld_so, libc, libm);
+    write_file("uselib.conf", conf, strlen(conf), uselib_conf);
+
+    // the in-process handler maps QMAGIC files only, the converted libm
+    // is only found through the premap table.
+    unsigned long premapped;
+    CHECK(run_gforth(uselib_conf, true, &premapped) == 0);
+    CHECK(premapped >= 2);
+    CHECK(run_gforth(uselib_conf, false, &premapped) != 0);
+    CHECK(premapped == 0);
+    return finish_tests("premap");
+}
@@ -0,0 +1,142 @@
+/**
+ * @file test.c
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief helpers shared by the tests.
+ *
+ * @details Every test is a program linked against librunaout.a, it creates
+ * its files in a temporary directory and exits with EXIT_FAILURE if a check
+ * failed, see the test target of the makefile.
+ */
+
+#undef __x86_64__ // undefine x86_64 env to make vscode
+				  // use 32-bit header files
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/limits.h>
+
+#include "run-aout.h"
+#include "test.h"
+
+static int failures = 0;
+static char directory[PATH_MAX - NAME_MAX - 1];
+
+/* start_tests
+ * @brief creates the temporary directory of a test.
+ **/
+void start_tests(void)
+{
+    logfile = stdout;
+    const char *tmpdir = getenv("TMPDIR") != NULL ? getenv("TMPDIR") : "/tmp";
+    snprintf(directory, sizeof(directory), "%s/run-aout-tests.XXXXXX", tmpdir);
+    if (mkdtemp(directory) == NULL) {
+        perror("mkdtemp");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/* finish_tests
+ * @brief removes the temporary directory and returns the exit status of a test.
+ * @param name the name of the test.
+ **/
+int finish_tests(const char *name)
+{
+    char command[PATH_MAX + 16];
+    snprintf(command, sizeof(command), "rm -rf '%s'", directory);
+    if (system(command) != 0) {
+        fprintf(stderr, "Warning: cannot remove '%s'.\n", directory);
+    }
+    printf("%s %s: %d checks failed\n", failures == 0 ? "PASS" : "FAIL", name, failures);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* check
+ * @brief counts and prints a failed check, see CHECK.
+ **/
+void check(int condition, const char *text, const char *file, int line)
+{
+    if (!condition) {
+        fprintf(stderr, "%s:%d: check failed: %s\n", file, line, text);
+        failures++;
+    }
+}
+
+/* temporary_path
+ * @brief returns the path of a file in the temporary directory.
+ * @param name the name of the file.
+ * @param buffer buffer of PATH_MAX bytes.
+ **/
+char *temporary_path(const char *name, char *buffer)
+{
+    snprintf(buffer, PATH_MAX, "%s/%s", directory, name);
+    return buffer;
+}
+
+/* write_file
+ * @brief creates a file in the temporary directory and returns its path.
+ * @param name the name of the file.
+ * @param data the contents of the file.
+ * @param size the size of the file.
+ * @param buffer buffer of PATH_MAX bytes.
+ **/
+char *write_file(const char *name, const void *data, size_t size, char *buffer)
+{
+    temporary_path(name, buffer);
+    FILE *file = fopen(buffer, "w");
+    if (file == NULL || fwrite(data, 1, size, file) != size || fclose(file) != 0) {
+        perror(buffer);
+        exit(EXIT_FAILURE);
+    }
+    return buffer;
+}
+
+/* make_test_aout
+ * @brief fills a struct test_aout.
+ **/
+void make_test_aout(struct test_aout *aout)
+{
+    memset(aout, 0, sizeof(struct test_aout));
+    aout->header.a_info = MAGIC_OMAGIC | (M_386 << 16);
+    aout->header.a_text = sizeof(aout->text);
+    aout->header.a_data = sizeof(aout->data);
+    aout->header.a_syms = sizeof(aout->symbols);
+    memcpy(aout->text, "text section...", 16);
+    memcpy(aout->data, "data...", 8);
+    memcpy(aout->strings, "_main\0_undef\0", 14);
+    aout->strings_size = sizeof(aout->strings_size) + sizeof(aout->strings);
+    aout->symbols[0].n_un.n_strx = 4;
+    aout->symbols[0].n_type = N_TEXT | N_EXT;
+    aout->symbols[0].n_value = 0x1234;
+    aout->symbols[1].n_un.n_strx = 10;
+    aout->symbols[1].n_type = N_UNDF | N_EXT;
+}
+
+/* read_member
+ * @brief returns true if a file or archive member has the expected contents.
+ **/
+bool read_member(struct member *member, const void *expected, size_t size)
+{
+    static char buffer[4 * 4096];
+    return member->size == (off_t)size && size <= sizeof(buffer)
+        && pread(member->fd, buffer, size, member->offset) == (ssize_t)size
+        && memcmp(buffer, expected, size) == 0;
+}
+
+/* open_error
+ * @brief returns the errno of open_member or 0 if it succeeded.
+ **/
+int open_error(const char *name)
+{
+    struct member member;
+    if (open_member(name, O_RDONLY | O_CLOEXEC, &member)) {
+        close(member.fd);
+        return 0;
+    }
+    return errno;
+}
@@ -0,0 +1,39 @@
+/**
+ * @file test.h
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief helpers shared by the tests.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "a.out.h"
+#include "archive.h"
+
+#ifndef TEST_H
+#define TEST_H
+
+#define CHECK(condition) check(condition, #condition, __FILE__, __LINE__)
+
+// a small OMAGIC file with a defined and an undefined symbol, see make_test_aout.
+struct test_aout {
+    struct exec header;
+    char text[16];
+    char data[8];
+    struct nlist symbols[2];
+    unsigned int strings_size;
+    char strings[14];
+};
+
+void start_tests(void);
+int finish_tests(const char *name);
+void check(int condition, const char *text, const char *file, int line);
+char *temporary_path(const char *name, char *buffer);
+char *write_file(const char *name, const void *data, size_t size, char *buffer);
+void make_test_aout(struct test_aout *aout);
+bool read_member(struct member *member, const void *expected, size_t size);
+int open_error(const char *name);
+
+#endif
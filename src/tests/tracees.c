@@ -0,0 +1,112 @@
+/**
+ * @file tracees.c
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief tests of the tracee table.
+ */
+
+#undef __x86_64__ // undefine x86_64 env to make vscode
+				  // use 32-bit header files
+
+#include <stdio.h>
+#include <string.h>
+
+#include "tracees.h"
+#include "test.h"
+
+// more than the initial capacity, such that the table is resized.
+#define MANY 1000
+
+/* sum_pids
+ * @brief for_each_tracee callback, adds the PID of every tracee.
+ **/
+static void sum_pids(traceep tracee, void *data)
+{
+    *(long *)data += tracee->pid;
+}
+
+/* test_resize
+ * @brief tracees keep their state when the table grows.
+ **/
+static void test_resize(void)
+{
+    struct tracee_table tracees;
+    memset(&tracees, 0, sizeof(tracees));
+    CHECK(get_tracee(&tracees, 1) == NULL);
+
+    for (pid_t pid = 1; pid <= MANY; pid++) {
+        traceep tracee = add_tracee(&tracees, pid);
+        CHECK(tracee != NULL && tracee->pid == pid && tracee->job == 0);
+        if (tracee != NULL) {
+            tracee->job = pid * 2;
+        }
+    }
+    CHECK(count_tracees(&tracees) == MANY);
+    CHECK(tracees.capacity >= 2 * MANY);
+
+    int found = 0;
+    for (pid_t pid = 1; pid <= MANY; pid++) {
+        traceep tracee = get_tracee(&tracees, pid);
+        found += tracee != NULL && tracee->job == pid * 2;
+    }
+    CHECK(found == MANY);
+    CHECK(get_tracee(&tracees, MANY + 1) == NULL);
+
+    long sum = 0;
+    for_each_tracee(&tracees, sum_pids, &sum);
+    CHECK(sum == (long)MANY * (MANY + 1) / 2);
+    free_tracees(&tracees);
+    CHECK(tracees.table == NULL && count_tracees(&tracees) == 0);
+}
+
+/* test_remove
+ * @brief removed tracees are skipped, their slots are reused and do not grow the table.
+ **/
+static void test_remove(void)
+{
+    struct tracee_table tracees;
+    memset(&tracees, 0, sizeof(tracees));
+    for (pid_t pid = 1; pid <= 20; pid++) {
+        add_tracee(&tracees, pid);
+    }
+    for (pid_t pid = 1; pid <= 20; pid += 2) {
+        remove_tracee(&tracees, pid);
+    }
+    remove_tracee(&tracees, 1);
+    remove_tracee(&tracees, 100);
+    CHECK(count_tracees(&tracees) == 10);
+    CHECK(get_tracee(&tracees, 3) == NULL && get_tracee(&tracees, 4) != NULL);
+
+    long sum = 0;
+    for_each_tracee(&tracees, sum_pids, &sum);
+    CHECK(sum == 110);
+
+    // a re-added PID starts with all state cleared.
+    get_tracee(&tracees, 4)->job = 4;
+    remove_tracee(&tracees, 4);
+    traceep tracee = add_tracee(&tracees, 4);
+    CHECK(tracee != NULL && tracee->job == 0 && get_tracee(&tracees, 4) == tracee);
+    get_tracee(&tracees, 6)->job = 6;
+    remove_tracee(&tracees, 4);
+    CHECK(get_tracee(&tracees, 4) == NULL);
+
+    // short lived tracees (e.g. children of a shell) do not grow the table.
+    int capacity = tracees.capacity;
+    for (pid_t pid = 1000; pid < 1000 + 10 * capacity; pid++) {
+        add_tracee(&tracees, pid);
+        remove_tracee(&tracees, pid);
+    }
+    CHECK(tracees.capacity == capacity);
+    CHECK(count_tracees(&tracees) == 9);
+    CHECK(get_tracee(&tracees, 6) != NULL && get_tracee(&tracees, 6)->job == 6);
+    free_tracees(&tracees);
+}
+
+int main(void)
+{
+    start_tests();
+    test_resize();
+    test_remove();
+    return finish_tests("tracees");
+}
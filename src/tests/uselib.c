@@ -0,0 +1,111 @@
+/**
+ * @file uselib.c
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief tests of uselib.conf, the compiled library index and the
+ * serialized mappings of the parameter block.
+ */
+
+#undef __x86_64__ // undefine x86_64 env to make vscode
+				  // use 32-bit header files
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <linux/limits.h>
+
+#include "uselib.h"
+#include "test.h"
+
+/* test_many_entries
+ * @brief an index with many colliding entries, every mapping is found.
+ **/
+static void test_many_entries(void)
+{
+    static char mappings[100 * 48];
+    int length = 0;
+    for (int i = 0; i < 100; i++) {
+        length += sprintf(mappings + length, "lib%d.so.1:/lib/lib%d.so.1.0\n", i, i);
+    }
+    char conf[PATH_MAX], index[PATH_MAX];
+    write_file("many.conf", mappings, length, conf);
+    temporary_path("many.index", index);
+    CHECK(compile_uselib_index(conf, NULL, 0, index));
+
+    struct uselib_table table;
+    memset(&table, 0, sizeof(table));
+    CHECK(open_uselib_index(&table, index));
+    int found = 0;
+    for (int i = 0; i < 100; i++) {
+        char key[32], expected[32];
+        snprintf(key, sizeof(key), "lib%d.so.1", i);
+        snprintf(expected, sizeof(expected), "/lib/lib%d.so.1.0", i);
+        char *value = get_entry(&table, key);
+        found += value != NULL && strcmp(value, expected) == 0;
+    }
+    CHECK(found == 100);
+    free_entries(&table);
+}
+
+/* test_uselib_index
+ * @brief mappings of uselib.conf and library directories, invalid indexes.
+ **/
+static void test_uselib_index(void)
+{
+    char conf[PATH_MAX], index[PATH_MAX], libraries[PATH_MAX], library[PATH_MAX];
+    // blank and malformed lines are skipped, the mappings after them are kept.
+    const char *mappings = "libc.so.4:/lib/libc.so.4.7.2\n\n  \nmalformed\nld.so:/lib/ld.so\n";
+    write_file("uselib.conf", mappings, strlen(mappings), conf);
+    temporary_path("libraries", libraries);
+    mkdir(libraries, 0755);
+
+    // QMAGIC libraries, the newest version of a major version is used.
+    struct exec header = { .a_info = MAGIC_QMAGIC | (M_386 << 16) };
+    write_file("libraries/libfoo.so.1.2.3", &header, sizeof(header), library);
+    write_file("libraries/libfoo.so.1.10.0", &header, sizeof(header), library);
+    write_file("libraries/libc.so.4.6.0", &header, sizeof(header), library);
+    write_file("libraries/libbar.so.2.0.0", "not an a.out file", 17, library);
+
+    char *directories[] = { libraries };
+    temporary_path("uselib.index", index);
+    CHECK(compile_uselib_index(conf, directories, 1, index));
+
+    struct uselib_table table;
+    memset(&table, 0, sizeof(table));
+    CHECK(open_uselib_index(&table, index));
+    char *value = get_entry(&table, "libc.so.4");
+    CHECK(value != NULL && strcmp(value, "/lib/libc.so.4.7.2") == 0);
+    value = get_entry(&table, "ld.so");
+    CHECK(value != NULL && strcmp(value, "/lib/ld.so") == 0);
+    value = get_entry(&table, "libfoo.so.1");
+    CHECK(value != NULL && strstr(value, "/libfoo.so.1.10.0") != NULL);
+    CHECK(get_entry(&table, "libbar.so.2") == NULL);
+    CHECK(get_entry(&table, "malformed") == NULL);
+    CHECK(get_entry(&table, "libmissing.so.1") == NULL);
+
+    // the serialized mappings passed to the trampoline, entries which do not fit are dropped.
+    char buffer[64];
+    memset(buffer, 0, sizeof(buffer));
+    struct uselib_table conf_table;
+    memset(&conf_table, 0, sizeof(conf_table));
+    read_uselibconf(&conf_table, conf);
+    CHECK(serialize_entries(&conf_table, buffer, sizeof(buffer)) == 0);
+    CHECK(serialize_entries(&conf_table, buffer, 24) == 1);
+    free_entries(&conf_table);
+    free_entries(&table);
+
+    // truncated and foreign files are no index.
+    memset(&table, 0, sizeof(table));
+    write_file("truncated.index", USELIB_INDEX_MAGIC, strlen(USELIB_INDEX_MAGIC), index);
+    CHECK(!open_uselib_index(&table, index));
+    CHECK(!open_uselib_index(&table, conf));
+}
+
+int main(void)
+{
+    start_tests();
+    test_uselib_index();
+    test_many_entries();
+    return finish_tests("uselib");
+}
@@ -0,0 +1,163 @@
+/**
+ * @file tracees.c
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief table of all processes traced by the controller.
+ *
+ * @details Open addressing hash table with linear probing keyed by PID,
+ * such that every ptrace event is dispatched in O(1). Pointers returned
+ * by add_tracee and get_tracee are only valid until the next add_tracee.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "tracees.h"
+
+#define INITIAL_CAPACITY 64
+#define REMOVED -1
+
+static unsigned int slot_of(struct tracee_table *tracees, pid_t pid)
+{
+    // Knuth's multiplicative hash, capacity is a power of two.
+    return ((unsigned int)pid * 2654435761u) & (tracees->capacity - 1);
+}
+
+/* resize
+ * @brief rehashes all live tracees into a table of the given capacity.
+ * @param tracees the table.
+ * @param new_capacity the new capacity, must be a power of two.
+ *
+ * @details Returns false if out of memory, the old table is kept then.
+ **/
+static bool resize(struct tracee_table *tracees, int new_capacity)
+{
+    traceep old_table = tracees->table;
+    int old_capacity = tracees->capacity;
+
+    traceep table = calloc(new_capacity, sizeof(struct tracee_t));
+    if (table == NULL) {
+        return false;
+    }
+    tracees->table = table;
+    tracees->capacity = new_capacity;
+    tracees->used = tracees->count;
+
+    for (int i = 0; i < old_capacity; i++) {
+        if (old_table[i].pid <= 0) {
+            continue;
+        }
+        unsigned int slot = slot_of(tracees, old_table[i].pid);
+        while (tracees->table[slot].pid != 0) {
+            slot = (slot + 1) & (tracees->capacity - 1);
+        }
+        tracees->table[slot] = old_table[i];
+    }
+    free(old_table);
+    return true;
+}
+
+/* add_tracee
+ * @brief adds a new tracee with all state cleared.
+ * @param tracees the table, an all zero table is empty.
+ * @param pid the PID of the tracee.
+ *
+ * @details Returns NULL if out of memory.
+ **/
+traceep add_tracee(struct tracee_table *tracees, pid_t pid)
+{
+    if (tracees->table == NULL) {
+        if (!resize(tracees, INITIAL_CAPACITY)) {
+            return NULL;
+        }
+    } else if ((tracees->used + 1) * 2 > tracees->capacity) {
+        // keep the load factor (including removed slots) below 1/2.
+        int capacity = tracees->count * 4 > tracees->capacity ? tracees->capacity * 2 : tracees->capacity;
+        if (!resize(tracees, capacity)) {
+            return NULL;
+        }
+    }
+
+    traceep table = tracees->table;
+    unsigned int slot = slot_of(tracees, pid);
+    while (table[slot].pid > 0) {
+        slot = (slot + 1) & (tracees->capacity - 1);
+    }
+    if (table[slot].pid == 0) {
+        tracees->used++;
+    }
+    tracees->count++;
+
+    memset(&table[slot], 0, sizeof(struct tracee_t));
+    table[slot].pid = pid;
+    return &table[slot];
+}
+
+/* get_tracee
+ * @brief returns the tracee with the given PID or NULL if not found.
+ * @param tracees the table.
+ * @param pid the PID of the tracee.
+ **/
+traceep get_tracee(struct tracee_table *tracees, pid_t pid)
+{
+    traceep table = tracees->table;
+    if (table == NULL) {
+        return NULL;
+    }
+    unsigned int slot = slot_of(tracees, pid);
+    while (table[slot].pid != 0) {
+        if (table[slot].pid == pid) {
+            return &table[slot];
+        }
+        slot = (slot + 1) & (tracees->capacity - 1);
+    }
+    return NULL;
+}
+
+/* remove_tracee
+ * @brief removes the tracee with the given PID, if present.
+ * @param tracees the table.
+ * @param pid the PID of the tracee.
+ **/
+void remove_tracee(struct tracee_table *tracees, pid_t pid)
+{
+    traceep tracee = get_tracee(tracees, pid);
+    if (tracee != NULL) {
+        tracee->pid = REMOVED;
+        tracees->count--;
+    }
+}
+
+/* count_tracees
+ * @brief returns the number of tracees in the table.
+ * @param tracees the table.
+ **/
+int count_tracees(struct tracee_table *tracees)
+{
+    return tracees->count;
+}
+
+/* for_each_tracee
+ * @brief calls callback for every tracee in the table.
+ * @param tracees the table.
+ * @param callback the function to call, must not add tracees.
+ * @param data passed to callback as is.
+ **/
+void for_each_tracee(struct tracee_table *tracees, void (*callback)(traceep tracee, void *data), void *data)
+{
+    for (int i = 0; i < tracees->capacity; i++) {
+        if (tracees->table[i].pid > 0) {
+            callback(&tracees->table[i], data);
+        }
+    }
+}
+
+/* free_tracees
+ * @brief releases the memory of the table, which is empty afterwards.
+ * @param tracees the table.
+ **/
+void free_tracees(struct tracee_table *tracees)
+{
+    free(tracees->table);
+    memset(tracees, 0, sizeof(struct tracee_table));
+}
@@ -0,0 +1,44 @@
+/**
+ * @file tracees.h
+ * @author Siegfried Pammer <e1633095@student.tuwien.ac.at>
+ * @date 17.10.2026
+ *
+ * @brief table of all processes traced by the controller.
+ */
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+#ifndef TRACEES_H
+#define TRACEES_H
+
+struct tracee_t {
+    pid_t pid;              /* 0 = free slot, -1 = removed */
+    bool aout_host;         /* the process image is the trampoline */
+    bool started;           /* the initial SIGSTOP was reported */
+    bool adopted;           /* the fork/clone event of the parent was reported */
+    bool in_syscall;        /* between syscall-enter-stop and syscall-exit-stop */
+    bool stop_requested;    /* PTRACE_INTERRUPT was sent to detach, the next interrupt- or group-stop detaches */
+    unsigned int libraries_loaded;   /* successful uselib calls of the current image */
+    unsigned int libraries_expected; /* library names in the image, see scan_libraries */
+    long breakpoint;        /* original data at the detach breakpoint */
+    pid_t job;              /* PID of the launched process this tracee belongs to */
+};
+
+typedef struct tracee_t *traceep;
+
+struct tracee_table {
+    traceep table;
+    int capacity;
+    int used;  /* live and removed slots */
+    int count; /* live slots */
+};
+
+traceep add_tracee(struct tracee_table *tracees, pid_t pid);
+traceep get_tracee(struct tracee_table *tracees, pid_t pid);
+void remove_tracee(struct tracee_table *tracees, pid_t pid);
+int count_tracees(struct tracee_table *tracees);
+void for_each_tracee(struct tracee_table *tracees, void (*callback)(traceep tracee, void *data), void *data);
+void free_tracees(struct tracee_table *tracees);
+
+#endif
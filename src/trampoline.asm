@@ -1,5 +1,88 @@
 global _start
 
+;; parameter block written by the controller
+;; NOTE: must be kept in sync with params.h
+PARAM_FD equ 1000
+PARAM_UFFD_FD equ 1002
+PARAM_READY_FD equ 1003
+PARAM_FLAG_INPROCESS equ 1h
+PARAM_FLAG_ENTRY_TRAP equ 2h
+PARAM_FLAG_LAZY equ 4h
+PARAM_FLAG_PREFAULT equ 8h
+PARAM_FLAG_HUGEPAGE equ 10h
+PARAM_FLAG_MLOCK equ 20h
+PARAM_FILTER_SIZE equ 64
+PARAM_LIBRARIES_SIZE equ 16384
+PARAM_PREMAP_MAX equ 8
+PARAM_PREMAP_PATHS_SIZE equ 1024
+
+struc premapped
+    .path:       resd 1
+    .name:       resd 1
+    .start:      resd 1
+    .length:     resd 1
+    .text_length: resd 1
+    .offset:     resd 1
+    .bss_start:  resd 1
+    .bss_length: resd 1
+endstruc
+
+struc params
+    .fd:         resd 1
+    .start:      resd 1
+    .length:     resd 1
+    .text_length: resd 1
+    .offset:     resd 1
+    .bss_start:  resd 1
+    .bss_length: resd 1
+    .entry:      resd 1
+    .text_offset: resd 1
+    .text_size:  resd 1
+    .data_start: resd 1
+    .data_size:  resd 1
+    .flags:      resd 1
+    .filter_len: resd 1
+    .filter:     resb PARAM_FILTER_SIZE
+    .libraries:  resb PARAM_LIBRARIES_SIZE
+    .premap_count: resd 1
+    .premap:     resb premapped_size * PARAM_PREMAP_MAX
+    .premap_paths: resb PARAM_PREMAP_PATHS_SIZE
+endstruc
+
+;; userfaultfd ioctls, _IOWR(0xAA, nr, struct uffdio_*)
+UFFDIO_API equ 0C018AA3Fh
+UFFDIO_REGISTER equ 0C020AA00h
+
+;; offsets of the saved registers in the ucontext passed to signal handlers
+UC_EBX equ 52
+UC_EAX equ 64
+
+section .data
+;; struct sigaction (kernel layout): handler, flags, restorer, mask
+_sigsys_action:
+    dd _sigsys_handler
+    dd 04000004h ;; SA_SIGINFO (0x4), SA_RESTORER (0x04000000)
+    dd _sigsys_restorer
+    dd 0, 0
+;; struct uffdio_api: api, features, ioctls (64 bit each)
+_uffdio_api:
+    dd 0AAh, 0 ;; UFFD_API
+    dd 2h, 0   ;; UFFD_FEATURE_EVENT_FORK
+    dd 0, 0
+;; struct uffdio_register: range.start, range.len, mode, ioctls (64 bit each)
+_uffdio_register:
+    dd 0, 0
+    dd 0, 0
+    dd 1h, 0 ;; UFFDIO_REGISTER_MODE_MISSING
+    dd 0, 0
+;; additional flags for mappings of images and bss (MAP_POPULATE, MAP_LOCKED)
+_map_flags: dd 0
+
+section .bss
+_params: resb params_size
+_sigsys_fprog: resd 2 ;; struct sock_fprog
+_lazy_ack: resb 1
+
 section .text
 _syscall_mmap_lib:
     push ebp
@@ -11,19 +94,28 @@ _syscall_mmap_lib:
     push esi
     push edi
 
+_syscall_mmap_lib_filename:
     mov ebx, 0xBADC0DE1 ;; filename
     call _syscall_open
     cmp eax, 0
     jl _syscall_mmap_lib_exit_enoent
 
     mov edx, eax
+_syscall_mmap_lib_start:
     mov ebx, 0xBADC0DE2 ;; start
+_syscall_mmap_lib_length:
     mov ecx, 0xBADC0DE3 ;; a_text + a_data
+_syscall_mmap_lib_text_length:
+    mov esi, 0xBADC0DE6 ;; a_text
+_syscall_mmap_lib_offset:
+    mov edi, 0xBADC0DE7 ;; offset of the library in the file
     call _syscall_mmap_exec
     cmp eax, -4095 ;; = -MAX_ERRNO
     jae _syscall_mmap_lib_exit
 
+_syscall_mmap_lib_bss_start:
     mov ebx, 0xBADC0DE4 ;; start + a_text + a_data
+_syscall_mmap_lib_bss_length:
     mov ecx, 0xBADC0DE5 ;; a_bss
     cmp ecx, 0 ;; bss_length != 0?
     je _syscall_mmap_lib_exit_success
@@ -46,18 +138,59 @@ _syscall_mmap_lib_exit:
 
     mov esp, ebp
     pop ebp
+_syscall_mmap_lib_return: ;; controller breakpoint
     ret
 _syscall_mmap_exec:
     ;; ebx = start
-    ;; ecx = length
+    ;; ecx = length of text and data
     ;; edx = fd
+    ;; esi = page aligned length of text or 0 if text is writable (OMAGIC)
+    ;; edi = page aligned offset of the image in the file (e.g. in an archive)
+    ;; text is mapped read-execute, such that its pages stay shared with
+    ;; the page cache, data is mapped read-write after it.
+    push ebx
+    push ecx
+    push edx
+    push esi
+    push edi
+    mov eax, 7 ;; prot = rwx
+    cmp esi, 0
+    je _syscall_mmap_exec_text
+    mov eax, 5 ;; prot = r-x
+    cmp esi, ecx
+    jae _syscall_mmap_exec_text
+    mov ecx, esi
+_syscall_mmap_exec_text:
+    push eax
     mov eax, ebx
     mov ebx, ecx
+    pop ecx      ;; prot
     mov esi, edx ;; move fd to esi
-    mov ecx, 7   ;; prot = rwx
-    mov edx, 12h ;; flags = PRIVATE (0x2), FIXED (0x10)
-    mov edi, 0   ;; offset = 0
+    mov edx, [_map_flags]
+    or edx, 12h  ;; flags = PRIVATE (0x2), FIXED (0x10)
     call _syscall_mmap
+    pop edi
+    pop esi
+    pop edx
+    pop ecx
+    pop ebx
+    cmp eax, -4095 ;; = -MAX_ERRNO
+    jae _syscall_mmap_exec_exit
+    cmp esi, 0
+    je _syscall_mmap_exec_exit
+    cmp esi, ecx
+    jae _syscall_mmap_exec_exit
+    ;; data follows text in the file and in memory
+    lea eax, [ebx+esi]
+    sub ecx, esi
+    mov ebx, ecx
+    mov ecx, 3   ;; prot = rw-
+    add edi, esi ;; offset = offset + length of text
+    mov esi, edx ;; move fd to esi
+    mov edx, [_map_flags]
+    or edx, 12h  ;; flags = PRIVATE (0x2), FIXED (0x10)
+    call _syscall_mmap
+_syscall_mmap_exec_exit:
     ret
 _syscall_mmap_bss:
     ;; ebx = start
@@ -65,11 +198,46 @@ _syscall_mmap_bss:
     mov eax, ebx
     mov ebx, ecx
     mov ecx, 3   ;; prot = rw-
-    mov edx, 32h ;; flags = PRIVATE (0x2), FIXED (0x10), ANONYMOUS (0x20)
+    mov edx, [_map_flags]
+    or edx, 32h  ;; flags = PRIVATE (0x2), FIXED (0x10), ANONYMOUS (0x20)
     mov esi, -1  ;; fd = -1 (none)
     mov edi, 0   ;; offset = 0
     call _syscall_mmap
     ret
+_map_bss_huge:
+    ;; ebx = start
+    ;; ecx = length
+    ;; maps bss like _syscall_mmap_bss, but lets the kernel use transparent
+    ;; huge pages (where alignment allows) before it is populated and locked.
+    push ebx
+    push ecx
+    push DWORD [_map_flags]
+    mov DWORD [_map_flags], 0
+    call _syscall_mmap_bss
+    pop DWORD [_map_flags]
+    pop ecx
+    pop ebx
+    cmp eax, -4095 ;; = -MAX_ERRNO
+    jae _map_bss_huge_exit
+    push eax
+    ;; failures are not fatal, the pages are faulted in on first access then
+    mov eax, 0dbh ;; madvise
+    mov edx, 14   ;; MADV_HUGEPAGE
+    int 80h
+    test DWORD [_map_flags], 8000h ;; MAP_POPULATE
+    jz _map_bss_huge_lock
+    mov eax, 0dbh ;; madvise
+    mov edx, 23   ;; MADV_POPULATE_WRITE
+    int 80h
+_map_bss_huge_lock:
+    test DWORD [_map_flags], 2000h ;; MAP_LOCKED
+    jz _map_bss_huge_done
+    mov eax, 96h ;; mlock
+    int 80h
+_map_bss_huge_done:
+    pop eax
+_map_bss_huge_exit:
+    ret
 _syscall_mmap:
     push ebp
     mov ebp, esp
@@ -82,10 +250,22 @@ _syscall_mmap:
     mov DWORD [esp+16], esi ;; fd
     mov DWORD [esp+20], edi ;; offset
 
+_syscall_mmap_retry:
     mov eax, 5ah
     mov ebx, esp
     int 80h
-    
+
+    ;; MAP_LOCKED fails beyond RLIMIT_MEMLOCK, map without locking then
+    cmp eax, -11 ;; EAGAIN
+    je _syscall_mmap_unlocked
+    cmp eax, -1 ;; EPERM
+    jne _syscall_mmap_exit
+_syscall_mmap_unlocked:
+    test DWORD [esp+12], 2000h ;; MAP_LOCKED
+    jz _syscall_mmap_exit
+    and DWORD [esp+12], 0ffffdfffh
+    jmp _syscall_mmap_retry
+_syscall_mmap_exit:
     mov esp, ebp
     pop ebp
     ret
@@ -108,6 +288,415 @@ _syscall_open:
     mov esp, ebp
     pop ebp
     ret
+_install_uselib_handler:
+    ;; installs _sigsys_handler and the seccomp filter from the
+    ;; parameter block, which raises SIGSYS for every uselib call.
+    ;; returns 0 or -errno in eax.
+    mov eax, 0aeh ;; rt_sigaction
+    mov ebx, 31   ;; SIGSYS
+    mov ecx, _sigsys_action
+    mov edx, 0    ;; no old action
+    mov esi, 8    ;; sizeof(sigset_t)
+    int 80h
+    cmp eax, 0
+    jne _install_uselib_handler_exit
+
+    ;; required to install a filter without CAP_SYS_ADMIN
+    mov eax, 0ach ;; prctl
+    mov ebx, 38   ;; PR_SET_NO_NEW_PRIVS
+    mov ecx, 1
+    mov edx, 0
+    mov esi, 0
+    mov edi, 0
+    int 80h
+    cmp eax, 0
+    jne _install_uselib_handler_exit
+
+    ;; struct sock_fprog: len (padded to 4 bytes), filter
+    mov eax, [_params + params.filter_len]
+    mov [_sigsys_fprog], eax
+    mov DWORD [_sigsys_fprog+4], _params + params.filter
+    mov eax, 0ach ;; prctl
+    mov ebx, 22   ;; PR_SET_SECCOMP
+    mov ecx, 2    ;; SECCOMP_MODE_FILTER
+    mov edx, _sigsys_fprog
+    int 80h
+_install_uselib_handler_exit:
+    ret
+_install_uselib_handler_call:
+    ;; entry point for the controller, e.g. before it detaches
+    call _install_uselib_handler
+_install_uselib_handler_return: ;; controller breakpoint
+    nop
+_reopen_fd:
+    ;; ebx = filename
+    ;; ecx = target fd
+    ;; opens filename and moves it to the target fd, used by the
+    ;; controller to hand over the parameter block before an execve.
+    ;; returns the target fd or -errno in eax.
+    call _syscall_open
+    cmp eax, 0
+    jl _reopen_fd_exit
+    cmp eax, ecx
+    je _reopen_fd_exit
+    mov ebx, eax
+    mov eax, 3fh ;; dup2
+    int 80h
+    push eax
+    mov eax, 6 ;; close
+    int 80h
+    pop eax
+_reopen_fd_exit:
+    ret
+_reopen_fd_call:
+    ;; entry point for the controller, see handle_execve
+    call _reopen_fd
+_reopen_fd_return: ;; controller breakpoint
+    nop
+_sigsys_handler:
+    ;; void handler(int sig, siginfo_t *info, ucontext_t *uc)
+    ;; emulates uselib inside the a.out process, see perform_uselib.
+    ;; the result is stored in the saved eax of the ucontext.
+    push ebp
+    mov ebp, esp
+    sub esp, 40
+    ;; [ebp-32]: struct exec header
+    ;; [ebp-36]: fd
+    ;; [ebp-40]: end of text and data / result
+
+    mov eax, [ebp+16]
+    mov esi, [eax+UC_EBX] ;; filename
+
+    ;; find the part of the filename after the last '/'
+    mov edi, esi
+    mov ecx, esi
+_sigsys_handler_basename:
+    mov al, [ecx]
+    inc ecx
+    cmp al, 0
+    je _sigsys_handler_lookup
+    cmp al, '/'
+    jne _sigsys_handler_basename
+    mov edi, ecx
+    jmp _sigsys_handler_basename
+
+_sigsys_handler_lookup:
+    ;; search the library table (key, value, ..., empty key) for a mapping,
+    ;; a key matches if it equals the basename (same as get_entry)
+    mov edx, _params + params.libraries
+_sigsys_handler_lookup_entry:
+    cmp BYTE [edx], 0
+    je _sigsys_handler_open ;; no mapping, use the filename as is
+    mov ecx, edi
+_sigsys_handler_lookup_compare:
+    mov al, [edx]
+    cmp al, [ecx]
+    jne _sigsys_handler_lookup_next
+    cmp al, 0
+    je _sigsys_handler_lookup_found
+    inc edx
+    inc ecx
+    jmp _sigsys_handler_lookup_compare
+_sigsys_handler_lookup_found:
+    lea esi, [edx+1] ;; the value follows the key
+    jmp _sigsys_handler_open
+_sigsys_handler_lookup_next:
+    call _skip_string ;; rest of the key
+    call _skip_string ;; value
+    jmp _sigsys_handler_lookup_entry
+
+_sigsys_handler_open:
+    ;; libraries mapped by _start are not mapped again
+    call _is_premapped
+    cmp eax, 0
+    je _sigsys_handler_exit
+    mov ebx, esi
+    call _syscall_open
+    cmp eax, 0
+    jl _sigsys_handler_exit
+    mov [ebp-36], eax
+
+    ;; read and validate the a.out header
+    mov ebx, eax
+    mov eax, 3 ;; read
+    lea ecx, [ebp-32]
+    mov edx, 32
+    int 80h
+    cmp eax, 32
+    jne _sigsys_handler_enoexec
+    cmp DWORD [ebp-32], 006400cch ;; QMAGIC, M_386, no flags
+    jne _sigsys_handler_enoexec
+
+    ;; map text and data at a_entry & 0xfffff000
+    mov ebx, [ebp-32+20] ;; a_entry
+    and ebx, 0fffff000h
+    mov ecx, [ebp-32+4]  ;; a_text
+    add ecx, [ebp-32+8]  ;; a_data
+    add ecx, 0fffh
+    and ecx, 0fffff000h
+    lea eax, [ebx+ecx]
+    mov [ebp-40], eax
+    mov edx, [ebp-36]
+    mov esi, [ebp-32+4]  ;; a_text
+    add esi, 0fffh
+    and esi, 0fffff000h
+    mov edi, 0           ;; offset = 0
+    call _syscall_mmap_exec
+    cmp eax, -4095 ;; = -MAX_ERRNO
+    jae _sigsys_handler_close
+
+    ;; optional: map bss after text and data
+    mov ecx, [ebp-32+12] ;; a_bss
+    add ecx, 0fffh
+    and ecx, 0fffff000h
+    jz _sigsys_handler_success
+    mov ebx, [ebp-40]
+    call _syscall_mmap_bss
+    cmp eax, -4095 ;; = -MAX_ERRNO
+    jae _sigsys_handler_close
+_sigsys_handler_success:
+    mov eax, 0
+    jmp _sigsys_handler_close
+_sigsys_handler_enoexec:
+    mov eax, -8 ;; ENOEXEC
+_sigsys_handler_close:
+    mov [ebp-40], eax
+    mov eax, 6 ;; close
+    mov ebx, [ebp-36]
+    int 80h
+    mov eax, [ebp-40]
+_sigsys_handler_exit:
+    mov ecx, [ebp+16]
+    mov [ecx+UC_EAX], eax
+
+    mov esp, ebp
+    pop ebp
+    ret
+_sigsys_restorer:
+    mov eax, 0adh ;; rt_sigreturn
+    int 80h
+_map_lazy:
+    ;; maps an empty region for .text and .data and registers it with a
+    ;; userfaultfd, the controller fills every page on its first access.
+    ;; Without a userfaultfd, the sections are read into the region.
+    ;; returns 0 or a negative error code in eax
+    mov eax, [_params + params.start]
+    mov ebx, [_params + params.length]
+    mov ecx, 7   ;; prot = rwx
+    mov edx, 32h ;; flags = PRIVATE (0x2), FIXED (0x10), ANONYMOUS (0x20)
+    mov esi, -1  ;; fd = -1 (none)
+    mov edi, 0   ;; offset = 0
+    call _syscall_mmap
+    cmp eax, -4095 ;; = -MAX_ERRNO
+    jae _map_lazy_exit
+
+    mov eax, 176h ;; userfaultfd
+    mov ebx, 80800h ;; O_CLOEXEC (0x80000), O_NONBLOCK (0x800)
+    int 80h
+    cmp eax, 0
+    jl _map_lazy_read
+    mov esi, eax ;; esi = userfaultfd
+    mov eax, 36h ;; ioctl
+    mov ebx, esi
+    mov ecx, UFFDIO_API
+    mov edx, _uffdio_api
+    int 80h
+    cmp eax, 0
+    jl _map_lazy_close
+
+    mov eax, [_params + params.start]
+    mov [_uffdio_register + 0], eax ;; range.start
+    mov eax, [_params + params.length]
+    mov [_uffdio_register + 8], eax ;; range.len
+    mov eax, 36h ;; ioctl
+    mov ebx, esi
+    mov ecx, UFFDIO_REGISTER
+    mov edx, _uffdio_register
+    int 80h
+    cmp eax, 0
+    jl _map_lazy_close
+
+    ; hand the userfaultfd over: the controller takes PARAM_UFFD_FD
+    ; (pidfd_getfd) once PARAM_READY_FD is closed and acknowledges
+    ; with a byte on PARAM_FD.
+    mov eax, 3fh ;; dup2
+    mov ebx, esi
+    mov ecx, PARAM_UFFD_FD
+    int 80h
+    cmp eax, 0
+    jl _map_lazy_close
+    mov eax, 6 ;; close
+    mov ebx, esi
+    int 80h
+    mov eax, 6 ;; close
+    mov ebx, PARAM_READY_FD
+    int 80h
+    mov eax, 3 ;; read
+    mov ebx, PARAM_FD
+    mov ecx, _lazy_ack
+    mov edx, 1
+    int 80h
+    cmp eax, 1
+    je _map_lazy_taken
+    mov eax, -5 ;; EIO
+    jmp _map_lazy_exit
+_map_lazy_taken:
+    mov eax, 6 ;; close
+    mov ebx, PARAM_UFFD_FD
+    int 80h
+    mov eax, 0
+    jmp _map_lazy_exit
+_map_lazy_close:
+    ; closing the only userfaultfd drops the registration
+    mov eax, 6 ;; close
+    mov ebx, esi
+    int 80h
+_map_lazy_read:
+    ; the controller finds no PARAM_UFFD_FD and leaves the image to us
+    mov eax, 6 ;; close
+    mov ebx, PARAM_READY_FD
+    int 80h
+    call _read_lazy
+_map_lazy_exit:
+    ret
+_read_lazy:
+    ;; reads .text and .data of the a.out file into the region mapped
+    ;; by _map_lazy, using the layout of write_image.
+    ;; returns 0 or a negative error code in eax
+    mov ecx, [_params + params.start]
+    mov edx, [_params + params.text_size]
+    mov esi, [_params + params.text_offset]
+    call _pread_all
+    cmp eax, 0
+    jne _read_lazy_exit
+    mov ecx, [_params + params.start]
+    add ecx, [_params + params.data_start]
+    mov edx, [_params + params.data_size]
+    mov esi, [_params + params.text_offset]
+    add esi, [_params + params.text_size]
+    call _pread_all
+_read_lazy_exit:
+    ret
+_pread_all:
+    ;; ecx = buffer, edx = size, esi = offset in the image file
+    ;; returns 0 or a negative error code in eax (EIO at end of file)
+    cmp edx, 0
+    je _pread_all_success
+    mov eax, 0b4h ;; pread64
+    mov ebx, [_params + params.fd]
+    mov edi, 0 ;; offset (high)
+    int 80h
+    cmp eax, -4 ;; EINTR
+    je _pread_all
+    cmp eax, 0
+    jl _pread_all_exit
+    je _pread_all_eof
+    add ecx, eax
+    sub edx, eax
+    add esi, eax
+    jmp _pread_all
+_pread_all_eof:
+    mov eax, -5 ;; EIO
+    ret
+_pread_all_success:
+    mov eax, 0
+_pread_all_exit:
+    ret
+_map_premapped:
+    ;; maps the libraries of the premap table like _syscall_mmap_lib.
+    ;; returns 0 or a negative error code in eax
+    push ebp
+    mov ebp, esp
+    sub esp, 12
+    ;; [ebp-4]: index
+    ;; [ebp-8]: pointer to the table entry
+    ;; [ebp-12]: fd / result
+    mov DWORD [ebp-4], 0
+_map_premapped_next:
+    mov eax, [ebp-4]
+    cmp eax, [_params + params.premap_count]
+    jae _map_premapped_success
+    imul edi, eax, premapped_size
+    add edi, _params + params.premap
+    mov [ebp-8], edi
+    mov ebx, [edi + premapped.path]
+    add ebx, _params + params.premap_paths
+    call _syscall_open
+    cmp eax, 0
+    jl _map_premapped_exit
+    mov [ebp-12], eax
+
+    mov edx, eax
+    mov ebx, [edi + premapped.start]
+    mov ecx, [edi + premapped.length]
+    mov esi, [edi + premapped.text_length]
+    mov edi, [edi + premapped.offset]
+    call _syscall_mmap_exec
+    mov ebx, [ebp-12]
+    mov [ebp-12], eax
+    mov eax, 6 ;; close
+    int 80h
+    mov eax, [ebp-12]
+    cmp eax, -4095 ;; = -MAX_ERRNO
+    jae _map_premapped_exit
+
+    ;; optional: map bss after text and data
+    mov edi, [ebp-8]
+    mov ebx, [edi + premapped.bss_start]
+    mov ecx, [edi + premapped.bss_length]
+    cmp ecx, 0
+    je _map_premapped_done
+    call _syscall_mmap_bss
+    cmp eax, -4095 ;; = -MAX_ERRNO
+    jae _map_premapped_exit
+_map_premapped_done:
+    inc DWORD [ebp-4]
+    jmp _map_premapped_next
+_map_premapped_success:
+    mov eax, 0
+_map_premapped_exit:
+    mov esp, ebp
+    pop ebp
+    ret
+_is_premapped:
+    ;; esi = filename (the uselib.conf mapping, if any)
+    ;; returns 0 in eax if _map_premapped mapped the file, -ENOENT otherwise.
+    ;; converted libraries are opened through another path, thus the name
+    ;; uselib requests resolve to is compared, not the path.
+    ;; clobbers ebx, ecx, edx and edi, same as the lookup in _sigsys_handler
+    mov ebx, 0
+_is_premapped_entry:
+    cmp ebx, [_params + params.premap_count]
+    jae _is_premapped_missing
+    imul edx, ebx, premapped_size
+    mov edx, [_params + params.premap + edx + premapped.name]
+    add edx, _params + params.premap_paths
+    mov ecx, esi
+_is_premapped_compare:
+    mov al, [edx]
+    cmp al, [ecx]
+    jne _is_premapped_next
+    cmp al, 0
+    je _is_premapped_found
+    inc edx
+    inc ecx
+    jmp _is_premapped_compare
+_is_premapped_next:
+    inc ebx
+    jmp _is_premapped_entry
+_is_premapped_found:
+    mov eax, 0
+    ret
+_is_premapped_missing:
+    mov eax, -2 ;; ENOENT
+    ret
+_skip_string:
+    ;; edx = pointer into a string, returns edx past its terminating NUL
+    mov al, [edx]
+    inc edx
+    cmp al, 0
+    jne _skip_string
+    ret
 _start:
     ; --- BEGIN STACK FIXUP ---
     ; execve produces some weird state on the stack
@@ -140,18 +729,101 @@ _start:
     push ebp
     mov ebp, esp
 
+    ; read the parameter block, it may arrive in several pieces
+    mov esi, _params
+    mov edi, params_size
+_start_read_params:
+    mov eax, 3 ; read
+    mov ebx, PARAM_FD
+    mov ecx, esi
+    mov edx, edi
+    int 80h
+    cmp eax, 0
+    jg _start_read_params_next
+    mov eax, -5 ; EIO
+    jmp _start_exit
+_start_read_params_next:
+    add esi, eax
+    sub edi, eax
+    jnz _start_read_params
+
+    ; optional: populate (and lock) the mappings, instead of faulting
+    ; in every page on first access
+    test DWORD [_params + params.flags], PARAM_FLAG_PREFAULT
+    jz _start_mlock
+    or DWORD [_map_flags], 8000h ;; MAP_POPULATE
+_start_mlock:
+    test DWORD [_params + params.flags], PARAM_FLAG_MLOCK
+    jz _start_uselib
+    or DWORD [_map_flags], 0a000h ;; MAP_POPULATE (0x8000), MAP_LOCKED (0x2000)
+_start_uselib:
+    ; optional: emulate uselib in this process
+    test DWORD [_params + params.flags], PARAM_FLAG_INPROCESS
+    jz _start_map
+    call _install_uselib_handler
+    cmp eax, 0
+    jne _start_exit
+_start_map:
+
+    ; optional: let the controller fill .text and .data on demand
+    test DWORD [_params + params.flags], PARAM_FLAG_LAZY
+    jz _start_map_file
+    call _map_lazy
+    cmp eax, 0
+    jne _start_exit
+    jmp _start_map_bss
+_start_map_file:
     ; map .text and .data
+    mov ebx, [_params + params.start]
+    mov ecx, [_params + params.length]
+    mov edx, [_params + params.fd]
+    mov esi, [_params + params.text_length]
+    mov edi, [_params + params.offset]
     call _syscall_mmap_exec
+    cmp eax, -4095 ;; = -MAX_ERRNO
+    jae _start_exit
+_start_map_bss:
     ; optional: map .bss
+    mov ebx, [_params + params.bss_start]
+    mov ecx, [_params + params.bss_length]
+    cmp ecx, 0
+    je _start_premap
+    test DWORD [_params + params.flags], PARAM_FLAG_HUGEPAGE
+    jz _start_map_bss_small
+    call _map_bss_huge
+    jmp _start_map_bss_check
+_start_map_bss_small:
     call _syscall_mmap_bss
+_start_map_bss_check:
+    cmp eax, -4095 ;; = -MAX_ERRNO
+    jae _start_exit
+_start_premap:
+    ; optional: map the libraries the controller found in the executable,
+    ; in one batch instead of one uselib call at a time
+    call _map_premapped
+    cmp eax, 0
+    jne _start_exit
+_start_close:
+    ; the image stays mapped, the a.out program does not need the fds
+    mov eax, 6 ; close
+    mov ebx, [_params + params.fd]
+    int 80h
+    mov eax, 6 ; close
+    mov ebx, PARAM_FD
+    int 80h
 
+    mov eax, [_params + params.entry]
     mov esp, ebp
     pop ebp
+    ; optional: let the controller know that the image is mapped
+    test DWORD [_params + params.flags], PARAM_FLAG_ENTRY_TRAP
+    jz _start_launch
+    int3
+_start_launch:
     ; launch
     jmp eax
-    ret
 _start_exit:
-    ; exit
+    ; exit with the (negative) error code in eax
     mov ebx, eax
     mov eax, 1
-    ret
\ No newline at end of file
+    int 80h
\ No newline at end of file
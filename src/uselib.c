@@ -4,15 +4,42 @@
  * @date 11.02.2020
  *
  * @brief provides a simple dictionary implementation to manage uselib.conf.
+ *
+ * @details Instead of uselib.conf, a compiled index can be used (see
+ * compile_uselib_index): an open addressing hash table of the mappings,
+ * which is mapped read-only and used in place, thus opening it does not
+ * depend on the number of mappings.
  */
+
+#define _GNU_SOURCE // strverscmp
+
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <string.h>
 #include <malloc.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <linux/limits.h>
 
+#include "a.out.h"
 #include "uselib.h"
 
-struct entry_t buckets[BUCKETS];
+// the index starts with this header, followed by the slots and the strings.
+struct index_header {
+    char magic[8];
+    uint32_t nslots;       /* power of two */
+    uint32_t strings_size; /* the strings end with a NUL byte */
+};
+
+struct index_slot {
+    uint32_t hash;  /* see fnv1a */
+    uint32_t key;   /* offset of the key in the strings, 0 = empty slot */
+    uint32_t value; /* offset of the value in the strings */
+};
 
 static unsigned long djb2(char *str)
 {
@@ -23,14 +50,49 @@ static unsigned long djb2(char *str)
     return hash % BUCKETS;
 }
 
+/* fnv1a
+ * @brief 32-bit FNV-1a hash of a key of the compiled index.
+ **/
+static uint32_t fnv1a(const char *str)
+{
+    uint32_t hash = 2166136261u;
+    while (*str)
+        hash = (hash ^ (unsigned char)*str++) * 16777619u;
+    return hash;
+}
+
+/* index_slots
+ * @brief returns the slots of the compiled index.
+ **/
+static const struct index_slot *index_slots(struct uselib_table *table)
+{
+    return (const struct index_slot *)(table->index + sizeof(struct index_header));
+}
+
+/* index_string
+ * @brief returns a string of the compiled index or NULL if the offset is invalid.
+ **/
+static char *index_string(struct uselib_table *table, uint32_t offset)
+{
+    const struct index_header *header = (const struct index_header *)table->index;
+    const char *strings = (const char *)(index_slots(table) + header->nslots);
+    // the last string is terminated, see open_uselib_index.
+    return offset < header->strings_size ? (char *)strings + offset : NULL;
+}
+
 /* add_entry
- * @brief emulates the uselib syscall.
- * @param pid PID of the a.out host process.
+ * @brief adds a mapping to the dictionary.
+ * @param table the uselib dictionary, it must not use an index.
+ * @param key the library name, e.g. "libc.so.4".
+ * @param value the path of the library.
+ *
+ * @details key and value are copied. A later mapping of the same key is
+ * stored, but get_entry returns the first one.
  **/
-void add_entry(char *key, char *value)
+void add_entry(struct uselib_table *table, char *key, char *value)
 {
     unsigned long bucket = djb2(key);
-    entryp entry = &buckets[bucket];
+    entryp entry = &table->buckets[bucket];
     while (entry->next != NULL) {
         entry = entry->next;
     }
@@ -40,43 +102,414 @@ void add_entry(char *key, char *value)
     memset(entry->next, 0, sizeof(struct entry_t));
 }
 
-/* get_entry
- * @brief emulates the uselib syscall.
- * @param pid PID of the a.out host process.
+/* find_entry
+ * @brief returns the first entry of the dictionary (not the index) with the given key.
  **/
-char *get_entry(char *key)
+static entryp find_entry(struct uselib_table *table, char *key)
 {
     unsigned long bucket = djb2(key);
-    entryp entry = &buckets[bucket];
+    entryp entry = &table->buckets[bucket];
     while (entry != NULL) {
-        if (entry->key != NULL && strncmp(key, entry->key, strlen(entry->key)) == 0)
-            return entry->value;
+        if (entry->key != NULL && strcmp(key, entry->key) == 0)
+            return entry;
         entry = entry->next;
     }
     return NULL;
 }
 
+/* get_entry
+ * @brief returns the path a library name is mapped to or NULL if there is no mapping.
+ * @param table the uselib dictionary.
+ * @param key the library name, e.g. "libc.so.4".
+ *
+ * @details Looks the name up in the compiled index if the table has one
+ * (see open_uselib_index), in the dictionary otherwise.
+ **/
+char *get_entry(struct uselib_table *table, char *key)
+{
+    if (table->index != NULL) {
+        const struct index_header *header = (const struct index_header *)table->index;
+        const struct index_slot *slots = index_slots(table);
+        uint32_t hash = fnv1a(key);
+        for (uint32_t i = 0; i < header->nslots; i++) {
+            const struct index_slot *slot = &slots[(hash + i) & (header->nslots - 1)];
+            if (slot->key == 0)
+                return NULL;
+            char *slot_key = index_string(table, slot->key);
+            if (slot->hash == hash && slot_key != NULL && strcmp(key, slot_key) == 0)
+                return index_string(table, slot->value);
+        }
+        return NULL;
+    }
+
+    entryp entry = find_entry(table, key);
+    return entry != NULL ? entry->value : NULL;
+}
+
+// state of serialize_entries.
+struct serialization {
+    char *buffer;
+    int size;
+    int offset;
+    int dropped; /* entries which did not fit */
+};
+
+/* serialize_entry
+ * @brief for_each_entry callback of serialize_entries.
+ **/
+static void serialize_entry(entryp entry, void *data)
+{
+    struct serialization *serialization = data;
+    int key_length = strlen(entry->key) + 1;
+    int value_length = strlen(entry->value) + 1;
+    // one byte is left for the terminating empty key.
+    if (serialization->offset + key_length + value_length >= serialization->size) {
+        serialization->dropped++;
+        return;
+    }
+    memcpy(serialization->buffer + serialization->offset, entry->key, key_length);
+    serialization->offset += key_length;
+    memcpy(serialization->buffer + serialization->offset, entry->value, value_length);
+    serialization->offset += value_length;
+}
+
+/* serialize_entries
+ * @brief writes the entries to buffer as a list of key\0value\0 pairs.
+ * @param buffer the buffer to write to.
+ * @param size the size of the buffer.
+ *
+ * @details The list is terminated by an empty key. Used to pass
+ * the mappings to the trampoline. Entries which do not fit are skipped,
+ * returns their number.
+ **/
+int serialize_entries(struct uselib_table *table, char *buffer, int size)
+{
+    struct serialization serialization = { buffer, size, 0, 0 };
+    for_each_entry(table, serialize_entry, &serialization);
+    buffer[serialization.offset] = '\0';
+    return serialization.dropped;
+}
+
+/* for_each_entry
+ * @brief calls a function for every entry.
+ * @param table the uselib dictionary.
+ * @param callback the function to call.
+ * @param data passed to callback.
+ **/
+void for_each_entry(struct uselib_table *table, void (*callback)(entryp entry, void *data), void *data)
+{
+    if (table->index != NULL) {
+        const struct index_header *header = (const struct index_header *)table->index;
+        const struct index_slot *slots = index_slots(table);
+        for (uint32_t i = 0; i < header->nslots; i++) {
+            struct entry_t entry = {
+                .key = slots[i].key != 0 ? index_string(table, slots[i].key) : NULL,
+                .value = index_string(table, slots[i].value),
+                .next = NULL
+            };
+            if (entry.key != NULL && entry.value != NULL) {
+                callback(&entry, data);
+            }
+        }
+        return;
+    }
+
+    for (int i = 0; i < BUCKETS; i++) {
+        for (entryp entry = &table->buckets[i]; entry != NULL; entry = entry->next) {
+            if (entry->key != NULL) {
+                callback(entry, data);
+            }
+        }
+    }
+}
+
+/* free_entries
+ * @brief removes all entries, the table can be reused afterwards.
+ * @param table the uselib dictionary.
+ **/
+void free_entries(struct uselib_table *table)
+{
+    if (table->index != NULL) {
+        munmap((void *)table->index, table->index_length);
+    }
+    for (int i = 0; i < BUCKETS; i++) {
+        entryp entry = &table->buckets[i];
+        free(entry->key);
+        free(entry->value);
+        entryp next = entry->next;
+        while (next != NULL) {
+            entry = next;
+            next = entry->next;
+            free(entry->key);
+            free(entry->value);
+            free(entry);
+        }
+    }
+    memset(table, 0, sizeof(struct uselib_table));
+}
+
 /* read_uselibconf
  * @brief reads the contents of uselib.conf and initializes the uselib dictionary.
+ * @param table the uselib dictionary.
+ * @param path the path of uselib.conf, a missing file is not an error.
  **/
-int read_uselibconf()
+int read_uselibconf(struct uselib_table *table, const char *path)
 {
-    FILE *uselib = fopen("uselib.conf", "r");
+    FILE *uselib = fopen(path, "r");
     if (uselib == NULL)
         return EXIT_SUCCESS;
-    
+
+    read_uselib_entries(table, uselib, path);
+    fclose(uselib);
+    return EXIT_SUCCESS;
+}
+
+/* read_uselib_entries
+ * @brief adds the mappings of an opened uselib.conf to the uselib dictionary.
+ * @param table the uselib dictionary.
+ * @param uselib the opened file, e.g. a bundle member (see fmemopen).
+ * @param name the name of the file in warnings.
+ *
+ * @details Blank lines are skipped. A line that is not "name:path" is
+ * reported with its line number and skipped as well.
+ **/
+int read_uselib_entries(struct uselib_table *table, FILE *uselib, const char *name)
+{
     char *line = NULL;
     size_t len = 0;
-    ssize_t r;
+    int number = 0;
 
-    while ((r = getline(&line, &len, uselib)) != EOF) {
+    while (getline(&line, &len, uselib) != EOF) {
+        number++;
+        if (line[strspn(line, " \t\r\n")] == '\0')
+            continue;
         char *save = NULL;
         char *key = strtok_r(line, ":\r\n", &save);
         char *value = strtok_r(NULL, ":\r\n", &save);
-        if (key == NULL || value == NULL)
-            break;
-        add_entry(key, value);
+        if (key == NULL || value == NULL) {
+            fprintf(stderr, "Warning: %s:%d: expected 'name:path', line ignored.\n", name, number);
+            continue;
+        }
+        add_entry(table, key, value);
     }
 
+    free(line);
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
+
+/* open_uselib_index
+ * @brief maps a compiled index (see compile_uselib_index) instead of reading uselib.conf.
+ * @param table the empty uselib dictionary.
+ * @param path the path of the index.
+ *
+ * @details Only the header is checked, the index is not read. Entries
+ * cannot be added to a table using an index. Returns false if the index
+ * is missing or invalid.
+ **/
+bool open_uselib_index(struct uselib_table *table, const char *path)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        return false;
+
+    struct stat st;
+    struct index_header header;
+    bool valid = fstat(fd, &st) == 0
+        && pread(fd, &header, sizeof(header), 0) == sizeof(header)
+        && memcmp(header.magic, USELIB_INDEX_MAGIC, sizeof(header.magic)) == 0
+        && header.nslots > 0 && (header.nslots & (header.nslots - 1)) == 0
+        && header.strings_size > 0
+        && (uint64_t)st.st_size == sizeof(header) + (uint64_t)header.nslots * sizeof(struct index_slot) + header.strings_size;
+    void *index = valid ? mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (index == MAP_FAILED)
+        return false;
+
+    // every string is terminated, if the last one is.
+    if (((const char *)index)[st.st_size - 1] != '\0') {
+        munmap(index, st.st_size);
+        return false;
+    }
+    table->index = index;
+    table->index_length = st.st_size;
+    return true;
+}
+
+/* add_directory
+ * @brief adds the QMAGIC libraries of a directory, like ldconfig.
+ * @param table the uselib dictionary.
+ * @param directory the path of the directory.
+ *
+ * @details A library "libc.so.4.7.2" is added as "libc.so.4", if there
+ * are several versions, the newest one is used.
+ **/
+static void add_directory(struct uselib_table *table, const char *directory)
+{
+    DIR *dir = opendir(directory);
+    if (dir == NULL) {
+        fprintf(stderr, "Warning: cannot read directory '%s'.\n", directory);
+        return;
+    }
+
+    struct dirent *file;
+    while ((file = readdir(dir)) != NULL) {
+        char *version = strstr(file->d_name, ".so.");
+        if (strncmp(file->d_name, "lib", 3) != 0 || version == NULL)
+            continue;
+
+        char path[PATH_MAX];
+        struct exec header;
+        snprintf(path, sizeof(path), "%s/%s", directory, file->d_name);
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd == -1)
+            continue;
+        bool library = pread(fd, &header, sizeof(header), 0) == sizeof(header) && N_MAGIC(header) == MAGIC_QMAGIC;
+        close(fd);
+        if (!library)
+            continue;
+
+        // the key ends after the major version.
+        char key[NAME_MAX + 1];
+        char *end = version + strlen(".so.");
+        while (*end >= '0' && *end <= '9')
+            end++;
+        snprintf(key, sizeof(key), "%.*s", (int)(end - file->d_name), file->d_name);
+
+        entryp entry = find_entry(table, key);
+        if (entry == NULL) {
+            add_entry(table, key, path);
+        } else if (strverscmp(file->d_name, strrchr(entry->value, '/') + 1) > 0) {
+            free(entry->value);
+            entry->value = strdup(path);
+        }
+    }
+    closedir(dir);
+}
+
+/* add_missing_entry
+ * @brief for_each_entry callback of compile_uselib_index.
+ **/
+static void add_missing_entry(entryp entry, void *data)
+{
+    if (get_entry(data, entry->key) == NULL)
+        add_entry(data, entry->key, entry->value);
+}
+
+// state of compile_uselib_index.
+struct index_builder {
+    struct index_slot *slots;
+    uint32_t nslots;
+    char *strings;
+    uint32_t strings_size;
+    uint32_t strings_capacity;
+    uint32_t count;
+    bool failed;
+};
+
+/* add_string
+ * @brief appends a string to the strings of the index, returns its offset.
+ **/
+static uint32_t add_string(struct index_builder *builder, const char *str)
+{
+    uint32_t length = strlen(str) + 1;
+    if (builder->strings_size + length > builder->strings_capacity) {
+        uint32_t capacity = (builder->strings_capacity + length) * 2;
+        char *strings = realloc(builder->strings, capacity);
+        if (strings == NULL) {
+            builder->failed = true;
+            return 0;
+        }
+        builder->strings = strings;
+        builder->strings_capacity = capacity;
+    }
+    memcpy(builder->strings + builder->strings_size, str, length);
+    builder->strings_size += length;
+    return builder->strings_size - length;
+}
+
+/* count_entry
+ * @brief for_each_entry callback of compile_uselib_index.
+ **/
+static void count_entry(entryp entry, void *data)
+{
+    (void)entry;
+    ((struct index_builder *)data)->count++;
+}
+
+/* insert_entry
+ * @brief for_each_entry callback of compile_uselib_index, the first entry of a key wins.
+ **/
+static void insert_entry(entryp entry, void *data)
+{
+    struct index_builder *builder = data;
+    uint32_t hash = fnv1a(entry->key);
+    uint32_t i = hash & (builder->nslots - 1);
+    while (builder->slots[i].key != 0) {
+        if (builder->slots[i].hash == hash && strcmp(builder->strings + builder->slots[i].key, entry->key) == 0)
+            return;
+        i = (i + 1) & (builder->nslots - 1);
+    }
+    builder->slots[i].hash = hash;
+    builder->slots[i].key = add_string(builder, entry->key);
+    builder->slots[i].value = add_string(builder, entry->value);
+}
+
+/* compile_uselib_index
+ * @brief compiles uselib.conf and library directories into an index.
+ * @param conf the path of uselib.conf, a missing file is not an error.
+ * @param directories directories searched for libraries, their mappings
+ * are only used if uselib.conf does not contain the name.
+ * @param count the number of directories.
+ * @param path the path of the index.
+ *
+ * @details The slots are an open addressing hash table (linear probing)
+ * with at least twice as many slots as entries. The index is written to
+ * a temporary file and renamed. Returns false and prints an error on failure.
+ **/
+bool compile_uselib_index(const char *conf, char *const directories[], int count, const char *path)
+{
+    struct uselib_table table, found;
+    memset(&table, 0, sizeof(table));
+    memset(&found, 0, sizeof(found));
+    read_uselibconf(&table, conf);
+    for (int i = 0; i < count; i++)
+        add_directory(&found, directories[i]);
+    for_each_entry(&found, add_missing_entry, &table);
+    free_entries(&found);
+
+    struct index_builder builder;
+    memset(&builder, 0, sizeof(builder));
+    for_each_entry(&table, count_entry, &builder);
+    builder.nslots = 16;
+    while (builder.nslots < 2 * builder.count)
+        builder.nslots *= 2;
+    builder.slots = calloc(builder.nslots, sizeof(struct index_slot));
+    add_string(&builder, ""); // offset 0 marks empty slots
+    if (builder.slots != NULL)
+        for_each_entry(&table, insert_entry, &builder);
+    free_entries(&table);
+
+    struct index_header header = { .nslots = builder.nslots, .strings_size = builder.strings_size };
+    memcpy(header.magic, USELIB_INDEX_MAGIC, sizeof(header.magic));
+    char temporary[PATH_MAX];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", path);
+    FILE *index = builder.slots != NULL && !builder.failed ? fopen(temporary, "w") : NULL;
+    bool success = index != NULL
+        && fwrite(&header, sizeof(header), 1, index) == 1
+        && fwrite(builder.slots, sizeof(struct index_slot), builder.nslots, index) == builder.nslots
+        && fwrite(builder.strings, 1, builder.strings_size, index) == builder.strings_size;
+    if (index != NULL && fclose(index) != 0)
+        success = false;
+    if (success && rename(temporary, path) != 0)
+        success = false;
+    if (!success) {
+        fprintf(stderr, "Error: cannot write the library index '%s'!\n", path);
+        unlink(temporary);
+    } else {
+        printf("%s: %u mappings\n", path, builder.count);
+    }
+
+    free(builder.slots);
+    free(builder.strings);
+    return success;
+}
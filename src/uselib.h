@@ -9,7 +9,12 @@
 #ifndef _USELIB_H
 #define _USELIB_H
 
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+
 #define BUCKETS 128
+#define USELIB_INDEX_MAGIC "AOUTLIB1"
 
 struct entry_t {
     char *key;
@@ -19,8 +24,20 @@ struct entry_t {
 
 typedef struct entry_t *entryp;
 
-void add_entry(char *key, char *value);
-char *get_entry(char *key);
-int read_uselibconf();
+struct uselib_table {
+    struct entry_t buckets[BUCKETS];
+    const char *index;   /* compiled index, see open_uselib_index, or NULL */
+    size_t index_length;
+};
+
+void add_entry(struct uselib_table *table, char *key, char *value);
+char *get_entry(struct uselib_table *table, char *key);
+int read_uselibconf(struct uselib_table *table, const char *path);
+int read_uselib_entries(struct uselib_table *table, FILE *uselib, const char *name);
+int serialize_entries(struct uselib_table *table, char *buffer, int size);
+void for_each_entry(struct uselib_table *table, void (*callback)(entryp entry, void *data), void *data);
+void free_entries(struct uselib_table *table);
+bool open_uselib_index(struct uselib_table *table, const char *path);
+bool compile_uselib_index(const char *conf, char *const directories[], int count, const char *path);
 
 #endif
\ No newline at end of file